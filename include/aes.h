@@ -36,4 +36,26 @@ int aes_decrypt(const uint8_t *in, size_t n,
                 const uint8_t *key, size_t klen,
                 uint8_t **out, size_t *outn);
 
+/**
+ * Tamaño exacto de la salida de aes_encrypt para n bytes de entrada
+ * (n más el padding PKCS#7, siempre entre 1 y 16 bytes)
+ */
+size_t aes_encrypted_size(size_t n);
+
+/**
+ * Igual que aes_encrypt pero escribe en un buffer del llamador de al menos
+ * aes_encrypted_size(n) bytes. out puede ser igual a in (cifrado en el lugar).
+ */
+int aes_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn);
+
+/**
+ * Igual que aes_decrypt pero escribe en un buffer del llamador de al menos
+ * n bytes. out puede ser igual a in (descifrado en el lugar).
+ */
+int aes_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn);
+
 #endif
@@ -0,0 +1,44 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "gsea.h"
+#include "container.h"
+
+/*
+ * Archivo sólido de varios miembros (--archive)
+ *
+ * Todos los archivos regulares del árbol de entrada, ordenados por nombre, se
+ * concatenan en un único flujo original seguido del índice central:
+ *
+ *   datos de cada miembro, uno detrás de otro
+ *   [u32 miembros]
+ *   miembros x [u64 offset][u64 tamaño][u16 largo del nombre][nombre]
+ *   [u64 largo del índice, sin estos 8 bytes]
+ *
+ * (big-endian; los nombres son relativos a la raíz, separados por '/'). Ese
+ * flujo se guarda como un contenedor normal con GSEA_HDR_ARCHIVE en el
+ * header: se corta en bloques y cada bloque pasa por la cadena -c/-e. Como
+ * los bloques cruzan los límites entre archivos, los archivos chicos
+ * comparten el header de Huffman, el diccionario de LZW y el padding del
+ * cifrado, y el índice queda comprimido y cifrado como el resto.
+ *
+ * Con la tabla de bloques del contenedor, un miembro se extrae decodificando
+ * solo los bloques que lo cubren (igual que --range) y la extracción completa
+ * reparte los bloques entre los hilos del pool.
+ */
+
+// empaqueta el directorio opt->in_path en el archivo opt->out_path
+int gsea_archive_create(const gsea_opts_t *opt);
+
+/**
+ * Si opt->in_path es un archivo de --archive y la cadena se deshace entera:
+ * extrae todos los miembros debajo del directorio opt->out_path, solo
+ * opt->member en el archivo opt->out_path, o los lista con opt->list.
+ * 'in_hdr' es el header de la entrada si el llamador ya lo leyó (NULL: se lee).
+ * @return 0 en éxito, -1 en error, 1 si la entrada no es un archivo de
+ *         --archive o la cadena no se deshace entera (procesar como
+ *         contenedor normal)
+ */
+int gsea_archive_extract(const gsea_opts_t *opt, const gsea_header_t *in_hdr);
+
+#endif
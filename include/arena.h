@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Arena por hilo para la memoria interna de los codecs (nodos del árbol de
+ * Huffman, diccionario de LZW). Cada hilo tiene la suya, así que no hay
+ * contención en el allocator; los bloques se reciclan entre llamadas y en
+ * régimen estable procesar un archivo no pide memoria al heap.
+ *
+ * Uso:
+ *     gsea_arena_t *a = gsea_arena_thread();
+ *     gsea_arena_mark_t m = gsea_arena_mark(a);
+ *     ... gsea_arena_alloc(a, n) ...
+ *     gsea_arena_release(a, m);   // libera todo lo pedido desde la marca
+ */
+
+typedef struct gsea_arena gsea_arena_t;
+
+typedef struct {
+    void  *chunk;
+    size_t used;
+} gsea_arena_mark_t;
+
+// arena del hilo actual (se crea al primer uso y se libera al terminar el hilo)
+gsea_arena_t *gsea_arena_thread(void);
+
+// memoria alineada a 16 bytes, sin inicializar; NULL si no hay memoria
+void *gsea_arena_alloc(gsea_arena_t *a, size_t n);
+
+gsea_arena_mark_t gsea_arena_mark(gsea_arena_t *a);
+void gsea_arena_release(gsea_arena_t *a, gsea_arena_mark_t m);
+
+/*
+ * Arena de cadenas con dueño explícito (no por hilo): muchas cadenas chicas
+ * que viven lo mismo (las rutas de un recorrido) se copian una detrás de otra
+ * en chunks grandes y se liberan todas juntas, sin un malloc por cadena.
+ * Inicializar en cero.
+ */
+typedef struct gsea_strchunk gsea_strchunk_t;
+
+typedef struct {
+    gsea_strchunk_t *head;
+} gsea_strarena_t;
+
+// n bytes contiguos sin alinear; NULL si no hay memoria
+char *gsea_strarena_alloc(gsea_strarena_t *a, size_t n);
+// pasa los chunks de src a dst (src queda vacía)
+void gsea_strarena_merge(gsea_strarena_t *dst, gsea_strarena_t *src);
+void gsea_strarena_free(gsea_strarena_t *a);
+
+/*
+ * Buffer que crece y se conserva entre usos: un worker lo reutiliza de un
+ * archivo al siguiente y en régimen estable no vuelve a pedir memoria.
+ */
+typedef struct {
+    uint8_t *data;
+    size_t   cap;
+} gsea_buf_t;
+
+// asegura al menos n bytes (el contenido previo no se conserva); 0 ok, -1 error
+int  gsea_buf_reserve(gsea_buf_t *b, size_t n);
+void gsea_buf_free(gsea_buf_t *b);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "gsea.h"
+#include "codec.h"
+#include "pipeline.h"
+
+/*
+ * --mem-budget N: tope para los buffers de trabajo de los workers. El camino
+ * de archivo completo carga la entrada entera más el par ping-pong entre
+ * etapas, así que con muchos workers y archivos grandes la memoria crece con
+ * el producto de ambos. Cada archivo se admite con la estimación de su pico
+ * (gsea_budget_estimate) y solo si entra junto a los que ya están en curso;
+ * si no, el worker espera. Un archivo que no entra ni solo pasa a modo stream
+ * (memoria acotada por --chunk-size) cuando la cadena lo permite.
+ *
+ * Cada worker conserva sus buffers entre archivos hasta 'keep' bytes, que se
+ * reservan de antemano: los archivos chicos no tocan el lock. Lo que un
+ * archivo pide de más durante la ejecución (una descompresión que expande
+ * más de lo estimado) se carga al salir de gsea_worker_reserve, así los
+ * siguientes esperan hasta que se libere.
+ */
+
+typedef struct gsea_budget {
+    uint64_t total;           // --mem-budget
+    uint64_t keep;            // lo que cada worker puede retener entre archivos
+    uint64_t limit;           // total menos lo retenido: para los archivos admitidos
+    uint64_t used, peak;
+    size_t running;           // archivos admitidos en curso
+    size_t waits;             // admisiones que tuvieron que esperar
+    size_t streamed;          // archivos pasados a modo stream
+    size_t workers;
+    gsea_step_t steps[sizeof(((gsea_opts_t *)0)->ops_order)];
+    int nsteps;
+    int can_stream;           // la cadena se puede aplicar por bloques
+    uint64_t chunk;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} gsea_budget_t;
+
+/**
+ * Prepara el presupuesto de opt->mem_budget para 'workers' workers que
+ * retienen buffers (hilos o slots en vuelo).
+ *
+ * @return       0 ok, -1 si la cadena de operaciones no es válida
+ */
+int gsea_budget_init(gsea_budget_t *b, const gsea_opts_t *opt, size_t workers);
+
+void gsea_budget_destroy(gsea_budget_t *b);
+
+// resumen [budget]: pico admitido, esperas y archivos pasados a modo stream
+void gsea_budget_report(const gsea_budget_t *b);
+
+// pico estimado del camino de archivo completo para una entrada de 'size' bytes
+uint64_t gsea_budget_estimate(const gsea_budget_t *b, uint64_t size);
+
+/**
+ * Memoria que necesitará el archivo 'opt->in_path' de 'size' bytes. Si no
+ * entra en el presupuesto y la cadena se puede aplicar por bloques, fija
+ * opt->stream y devuelve lo que usa el modo stream.
+ */
+uint64_t gsea_budget_fit(gsea_budget_t *b, gsea_opts_t *opt, uint64_t size);
+
+// espera a que 'need' bytes entren en el presupuesto y los asigna a 'w';
+// sin nada más en curso se admite aunque no entre
+void gsea_budget_begin(gsea_budget_t *b, gsea_worker_t *w, uint64_t need);
+
+// como gsea_budget_begin sin esperar: 1 si se admitió, 0 si no entra todavía.
+// 'retry' distinto de cero si ya se intentó (la espera se cuenta una vez)
+int gsea_budget_try_begin(gsea_budget_t *b, gsea_worker_t *w, uint64_t need, int retry);
+
+// devuelve lo que cargó 'w' y le libera los buffers que pasan de 'keep'
+void gsea_budget_end(gsea_budget_t *b, gsea_worker_t *w);
+
+// buffers de un worker que crecieron más allá de lo admitido
+void gsea_budget_charge(gsea_budget_t *b, uint64_t n);
+
+#endif
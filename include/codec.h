@@ -0,0 +1,78 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gsea.h"
+
+/*
+ * Registro de codecs: cada algoritmo de compresión o cifrado se describe con
+ * una tabla de funciones y sus capacidades, así el pipeline, el contenedor y
+ * el modo --mmap despachan por la misma entrada en vez de comparar nombres.
+ */
+
+// ids de algoritmo (se guardan en el contenedor, no cambiar)
+enum {
+    GSEA_ALG_RLE      = 1,
+    GSEA_ALG_LZW      = 2,
+    GSEA_ALG_HUFFMAN  = 3,
+    GSEA_ALG_VIGENERE = 16,
+    GSEA_ALG_DES      = 17,
+    GSEA_ALG_AES      = 18
+};
+
+// capacidades
+#define GSEA_CODEC_INPLACE   (1u << 0)  // forward/inverse aceptan out == in
+#define GSEA_CODEC_SAMESIZE  (1u << 1)  // la salida mide lo mismo que la entrada
+#define GSEA_CODEC_PADDED    (1u << 2)  // solo agrega/quita padding hasta block_size
+#define GSEA_CODEC_STREAMING (1u << 3)  // cada bloque se transforma sin estado previo
+#define GSEA_CODEC_NEEDS_KEY (1u << 4)
+
+// padding máximo de los cifrados por bloques: reservar este extra en un
+// buffer permite cifrarlo en el lugar
+#define GSEA_CODEC_MAX_PAD   16
+
+typedef int (*gsea_codec_bound_fn)(const uint8_t *in, size_t n, size_t *size);
+typedef int (*gsea_codec_fn)(const uint8_t *in, size_t n,
+                             const uint8_t *key, size_t klen,
+                             uint8_t *out, size_t *outn);
+
+typedef struct {
+    const char *name;
+    uint8_t     id;
+    char        kind;             // 'c' compresión, 'e' cifrado
+    unsigned    flags;
+    size_t      block_size;       // bloque del cifrado (1 si trabaja por byte)
+    // tamaño de la salida antes de ejecutar: exacto, o cota superior cuando
+    // depende del contenido (compresión, quitar padding). forward_bound
+    // acepta in == NULL y da entonces la cota del peor caso
+    gsea_codec_bound_fn forward_bound;
+    gsea_codec_bound_fn inverse_bound;
+    gsea_codec_fn       forward;  // comprimir / cifrar
+    gsea_codec_fn       inverse;  // descomprimir / descifrar
+} gsea_codec_t;
+
+// un paso de una cadena: operación y algoritmo ya resuelto
+typedef struct {
+    char    op;                   // 'c', 'd', 'e' o 'u'
+    uint8_t alg;
+} gsea_step_t;
+
+const gsea_codec_t *gsea_codec_by_id(uint8_t id);
+const gsea_codec_t *gsea_codec_find(char kind, const char *name);
+
+/**
+ * Resuelve el codec de la operación 'op' con los algoritmos de 'opt'
+ * (rle y vigenere por defecto). Informa por stderr si no existe o si falta
+ * la clave.
+ *
+ * @return       el codec, o NULL en error
+ */
+const gsea_codec_t *gsea_codec_for_op(const gsea_opts_t *opt, char op);
+
+// 'c'/'e' aplican forward; 'd'/'u' aplican inverse
+static inline int gsea_step_inverse(char op){
+    return op == 'd' || op == 'u';
+}
+
+#endif
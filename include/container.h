@@ -0,0 +1,93 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gsea.h"
+#include "codec.h"
+
+/*
+ * Contenedor autodescriptivo de los modos por bloques
+ *
+ *   [magic "\x89GSEA\r\n\x1a"][u8 versión][u8 flags][u8 nsteps][u8 0]
+ *   [u32 tamaño de bloque][u64 tamaño original]
+ *   nsteps x [u8 operación ('c'|'e')][u8 id de algoritmo]
+ *   frames ... marcador de fin, tabla de bloques y trailer (ver stream.h)
+ *
+ * La cadena de pasos es una pila: cada -c/-e apila su algoritmo y cada -d/-u
+ * desapila el último paso del mismo tipo, tomando el algoritmo registrado
+ * (no hace falta repetir --comp-alg/--enc-alg para recuperar). Cuando la
+ * pila queda vacía la salida es el archivo original sin contenedor.
+ * El tamaño original vale UINT64_MAX si la salida no era seekable.
+ *
+ * Versión 2: cada frame lleva el CRC32C de su payload y del bloque original
+ * (ver stream.h). flags & GSEA_HDR_RAW_CRC indica que el segundo es válido;
+ * no lo es si el contenedor se derivó de uno de versión 1 sin deshacerlo.
+ * flags & GSEA_HDR_ARCHIVE indica que el original es un archivo de varios
+ * miembros (ver archive.h) y GSEA_HDR_DEDUP que es un almacén de chunks
+ * (ver dedup.h); ambos se conservan al agregar o quitar pasos.
+ */
+
+#define GSEA_MAGIC       "\x89GSEA\r\n\x1a"
+#define GSEA_MAGIC_LEN   8
+#define GSEA_VERSION     2
+#define GSEA_VERSION_MIN 1         // versión más vieja que se sigue leyendo
+#define GSEA_MAX_STEPS   16
+#define GSEA_HDR_FIXED   24
+
+// flags del header
+#define GSEA_HDR_RAW_CRC 0x01      // los frames traen el CRC del original
+#define GSEA_HDR_ARCHIVE 0x02      // el original es un archivo de --archive
+#define GSEA_HDR_DEDUP   0x04      // almacén de chunks de --dedup (ver dedup.h)
+
+typedef struct {
+    uint8_t  version;
+    uint8_t  flags;
+    uint32_t chunk_size;
+    uint64_t orig_size;
+    int      nsteps;
+    gsea_step_t steps[GSEA_MAX_STEPS];   // en orden de aplicación
+} gsea_header_t;
+
+// cadena resuelta para un archivo: qué se lee, qué se ejecuta y qué se escribe
+typedef struct {
+    int framed_in;                // la entrada es un contenedor
+    gsea_header_t in_hdr;
+    int nsteps;
+    gsea_step_t steps[GSEA_MAX_STEPS];   // operaciones a ejecutar por bloque
+    int framed_out;               // la salida es un contenedor
+    gsea_header_t out_hdr;
+} gsea_plan_t;
+
+size_t gsea_header_size(const gsea_header_t *hdr);
+int gsea_header_write(int fd, const gsea_header_t *hdr);
+// actualiza el tamaño original en el header ya escrito (si fd es seekable)
+void gsea_header_patch_size(int fd, uint64_t orig_size);
+
+/**
+ * Detecta si fd (posicionado al inicio) es un contenedor. Si lo es, lee el
+ * header y deja fd posicionado en el primer frame. En un pipe la detección
+ * consume bytes: si no es contenedor quedan en 'pre' (GSEA_HDR_FIXED bytes
+ * como máximo, *pre_len) y el llamador debe procesarlos antes que el resto.
+ * @return 1 si es contenedor, 0 si no, -1 si el header es inválido
+ */
+int gsea_container_probe(int fd, gsea_header_t *hdr, uint8_t *pre, size_t *pre_len);
+
+/**
+ * Resuelve la cadena de opt contra el contenedor de entrada (si lo hay).
+ * @return 0 en éxito, -1 si la cadena no es aplicable
+ */
+int gsea_plan_build(const gsea_opts_t *opt, int framed_in,
+                    const gsea_header_t *in_hdr, size_t chunk, gsea_plan_t *plan);
+
+/**
+ * Aplica los pasos [from, to) del plan sobre un bloque. Si la entrada es un
+ * contenedor, 'raw_len' es el tamaño original del bloque (el del frame) y
+ * acota lo que puede producir cada paso que se deshace: un bloque dañado se
+ * rechaza antes de reservar la salida que dice tener.
+ */
+int gsea_plan_apply(const gsea_plan_t *plan, const gsea_opts_t *opt,
+                    uint32_t raw_len, int from, int to,
+                    const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef CPUS_H
+#define CPUS_H
+
+#include "gsea.h"
+
+/**
+ * CPUs que este proceso puede usar de verdad: el mínimo entre la máscara de
+ * afinidad (taskset, cpuset) y la cuota de CPU del cgroup (cpu.max en v2,
+ * cpu.cfs_quota_us en v1, redondeada hacia arriba), recorriendo también los
+ * cgroups ancestros. En un contenedor con 2 CPUs de cuota sobre un host de
+ * 96 cores devuelve 2, no 96. Se calcula una vez.
+ *
+ * @return       al menos 1
+ */
+int gsea_cpu_count(void);
+
+// workers de cómputo: --jobs si se pasó, si no gsea_cpu_count()
+int gsea_jobs(const gsea_opts_t *opt);
+
+#endif
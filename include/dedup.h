@@ -0,0 +1,39 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include "gsea.h"
+
+/*
+ * Deduplicación entre archivos (--dedup, con un directorio de entrada)
+ *
+ * Cada archivo se corta en chunks de tamaño variable con FastCDC: un hash
+ * gear rodante elige los cortes según el contenido, así una inserción al
+ * principio de un archivo solo cambia los chunks que la tocan y dos archivos
+ * casi iguales (rotaciones de logs, imágenes de VM, copias) comparten casi
+ * todos sus chunks. El tamaño medio es --chunk-size (64 KiB por defecto,
+ * redondeado a potencia de 2), con mínimo de 1/4 y máximo de 4 veces.
+ *
+ * Los chunks se identifican por su SHA-256 y cada chunk distinto pasa una sola
+ * vez por la cadena -c/-e: el almacén <salida>/.gsea-chunks es un contenedor
+ * con GSEA_HDR_DEDUP cuyo bloque i es el chunk número i. Cada archivo de la
+ * salida es su receta:
+ *
+ *   [magic "\x89GSDD\r\n\x1a"][u64 tamaño original][u32 chunks]
+ *   chunks x [u32 número de chunk]
+ *
+ * (big-endian). Con -d/-u (o sin operaciones) sobre un directorio así se
+ * reconstruye cada archivo decodificando sus chunks desde el almacén; -d/-u
+ * sin --dedup lo detecta por el almacén (gsea_dedup_detect).
+ */
+
+#define GSEA_DEDUP_STORE ".gsea-chunks"
+#define GSEA_DEDUP_MAGIC     "\x89GSDD\r\n\x1a"
+#define GSEA_DEDUP_MAGIC_LEN 8
+
+// -c/-e: deduplica opt->in_path en opt->out_path; si no, lo reconstruye
+int gsea_process_dedup(const gsea_opts_t *opt);
+
+// 1 si el directorio 'dir' es una salida de --dedup (tiene el almacén)
+int gsea_dedup_detect(const char *dir);
+
+#endif
@@ -36,4 +36,26 @@ int des_decrypt(const uint8_t *in, size_t n,
                 const uint8_t *key, size_t klen,
                 uint8_t **out, size_t *outn);
 
+/**
+ * Tamaño exacto de la salida de des_encrypt para n bytes de entrada
+ * (n más el padding PKCS#7, siempre entre 1 y 8 bytes)
+ */
+size_t des_encrypted_size(size_t n);
+
+/**
+ * Igual que des_encrypt pero escribe en un buffer del llamador de al menos
+ * des_encrypted_size(n) bytes. out puede ser igual a in.
+ */
+int des_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn);
+
+/**
+ * Igual que des_decrypt pero escribe en un buffer del llamador de al menos
+ * n bytes. out puede ser igual a in.
+ */
+int des_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn);
+
 #endif
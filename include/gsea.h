@@ -1,6 +1,9 @@
 #ifndef GSEA_H
 #define GSEA_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 typedef enum {
     OP_NONE = 0,
     OP_COMPRESS = 1,
@@ -17,8 +20,36 @@ typedef struct {
     const char *key;      // -k (opcional)
     const char *comp_alg; // --comp-alg
     const char *enc_alg;  // --enc-alg
+    int    stream;        // --stream: procesar por bloques de tamaño fijo
+    size_t chunk_size;    // --chunk-size (bytes por bloque en modo stream)
+    int    parallel_blocks; // --blocks: bloques repartidos entre todos los cores
+    int    pipelined;     // --pipeline: un hilo por etapa en modo stream
+    int    use_mmap;      // --mmap: entrada/salida mapeadas en memoria
+    int      has_range;      // --range off:len sobre un contenedor
+    int      range_from_end; // off se cuenta desde el final ("-64K:")
+    uint64_t range_off;
+    uint64_t range_len;      // UINT64_MAX = hasta el final
+    int    no_uring;      // --no-uring: directorios con E/S bloqueante
+    int    verify;        // --verify: decodificar y comprobar CRCs sin escribir
+    int    recursive;     // -r: recorrer también los subdirectorios
+    int    jobs;          // -j N: workers de cómputo; 0 = según CPUs disponibles
+    int    archive;       // --archive: empaquetar el directorio en un solo archivo
+    const char *member;   // --member NAME: extraer solo ese miembro del archivo
+    int    list;          // --list: listar los miembros del archivo
+    const char *manifest; // --manifest FILE: reprocesar solo lo que cambió
+    int    dedup;         // --dedup: chunks de contenido deduplicados entre archivos
+    int    verbosity;     // -v suma un nivel de mensajes, -q resta uno
+    int    log_json;      // --log-json: mensajes como líneas JSON
+    int    stats;         // --stats[=FILE]: reporte JSON de tiempos al terminar
+    const char *stats_path; // FILE de --stats; NULL = stderr
+    size_t mem_budget;    // --mem-budget N: tope de los buffers de trabajo; 0 = sin tope
 } gsea_opts_t;
 
+// tamaño de bloque por defecto del modo stream (1 MiB)
+#define GSEA_DEFAULT_CHUNK (1u << 20)
+// límite superior: las longitudes de bloque se guardan en 32 bits
+#define GSEA_MAX_CHUNK     (1u << 30)
+
 // helpers actuales
 int fs_is_dir(const char *path);              // 1 si dir, 0 si no, -1 error
 int fs_copy_file(const char *infile, const char *outfile);
@@ -15,6 +15,18 @@
  */
 int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
 
+/**
+ * Cota superior del tamaño de la salida de huffman_compress para n bytes:
+ * el header más n (los códigos nunca promedian más de 8 bits por byte)
+ */
+size_t huffman_compressed_bound(size_t n);
+
+/**
+ * Igual que huffman_compress pero escribe en un buffer del llamador de al
+ * menos huffman_compressed_bound(n) bytes
+ */
+int huffman_compress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn);
+
 /**
  * Descomprime datos comprimidos con codificación de Huffman
  * 
@@ -26,4 +38,17 @@ int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
  */
 int huffman_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
 
+/**
+ * Lee del header el tamaño que tendrá la salida de huffman_decompress
+ * 
+ * @return       0 en éxito, -1 si el header es inválido
+ */
+int huffman_decompressed_size(const uint8_t *in, size_t n, size_t *size);
+
+/**
+ * Igual que huffman_decompress pero escribe en un buffer del llamador de al
+ * menos huffman_decompressed_size() bytes
+ */
+int huffman_decompress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn);
+
 #endif
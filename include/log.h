@@ -0,0 +1,54 @@
+#ifndef LOG_H
+#define LOG_H
+
+/*
+ * Mensajes de progreso y diagnóstico ([pool], [walk], uno por archivo...).
+ * Cada hilo escribe en su propio anillo sin locks y un solo hilo escritor los
+ * vacía a stderr en lotes, ordenados por hora, con un write(2) por lote: los
+ * workers no se serializan en el lock de stdio. Si un anillo se llena los
+ * mensajes de debug y trace se descartan (y se avisa cuántos); los de nivel
+ * info o más esperan lugar.
+ *
+ * El nivel se elige con -q / -v (se pueden repetir) y --log-json cambia el
+ * formato a una línea JSON por mensaje:
+ *
+ *   {"ts":1760000000.123456,"level":"info","thread":3,"tag":"pool","msg":"..."}
+ *
+ * Uso:
+ *     GSEA_LOG(GSEA_LOG_INFO, "pool", "workers=%zu", n);
+ *
+ * Con el nivel desactivado la macro no evalúa los argumentos.
+ */
+
+typedef enum {
+    GSEA_LOG_ERROR = 0,
+    GSEA_LOG_WARN,
+    GSEA_LOG_INFO,                // por defecto: resúmenes de cada etapa
+    GSEA_LOG_DEBUG,               // -v: una línea por archivo
+    GSEA_LOG_TRACE                // -vv: plan de trabajo y cada inicio
+} gsea_log_level_t;
+
+// nivel máximo que se muestra; se fija con gsea_log_init antes de crear hilos
+extern int gsea_log_level;
+
+#define GSEA_LOG(lvl, tag, ...) do { \
+        if ((int)(lvl) <= gsea_log_level) gsea_log_write((lvl), (tag), __VA_ARGS__); \
+    } while (0)
+
+/**
+ * Fija el nivel y el formato. El hilo escritor arranca con el primer mensaje;
+ * lo pendiente se vacía al terminar el programa (atexit).
+ */
+void gsea_log_init(int level, int json);
+
+/**
+ * Encola un mensaje. 'tag' va entre corchetes en el formato de texto; NULL
+ * para un mensaje sin etiqueta. Antes de gsea_log_init se escribe directo.
+ */
+void gsea_log_write(int level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// espera a que todo lo encolado hasta ahora esté escrito
+void gsea_log_flush(void);
+
+#endif
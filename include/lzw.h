@@ -26,4 +26,30 @@ int lzw_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
  */
 int lzw_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn);
 
+/**
+ * Cota superior del tamaño de la salida de lzw_compress para n bytes
+ * (un código de 12 bits por byte, el peor caso con datos aleatorios)
+ */
+size_t lzw_compressed_bound(size_t n);
+
+/**
+ * Igual que lzw_compress pero escribe en un buffer del llamador de al menos
+ * lzw_compressed_bound(n) bytes
+ */
+int lzw_compress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn);
+
+/**
+ * Calcula el tamaño exacto de la salida de lzw_decompress recorriendo los
+ * códigos sin escribir datos
+ * 
+ * @return       0 en éxito, -1 si la entrada es inválida
+ */
+int lzw_decompressed_size(const uint8_t *in, size_t n, size_t *size);
+
+/**
+ * Igual que lzw_decompress pero escribe en un buffer del llamador de al
+ * menos lzw_decompressed_size() bytes
+ */
+int lzw_decompress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn);
+
 #endif
@@ -0,0 +1,65 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gsea.h"
+#include "walk.h"
+#include "arena.h"
+#include "sha256.h"
+
+/*
+ * Manifiesto de --manifest FILE para reprocesar un directorio en forma
+ * incremental. Guarda, por cada archivo de entrada procesado sin error, su
+ * tamaño, mtime, inodo y SHA-256, más la cadena de operaciones de la corrida:
+ *
+ *   gsea-manifest 1\t<cadena>
+ *   <tamaño> <mtime en ns> <inodo> <sha256 en hex> <ruta relativa>
+ *   ...
+ *
+ * En la corrida siguiente un archivo se saltea si tamaño, mtime e inodo
+ * coinciden y su salida existe, sin leerlo. Si solo cambiaron mtime o inodo
+ * (un touch, una copia) se compara el SHA-256 y se saltea si el contenido es
+ * el mismo. Si la cadena de operaciones cambió se procesa todo. La clave no
+ * se guarda: si la cadena cifra, lleva "key=<sal>:<marca>", con una sal
+ * aleatoria del manifiesto y 16 bytes de PBKDF2-HMAC-SHA256 de la clave, así
+ * cambiar -k también reprocesa todo.
+ */
+
+typedef struct {
+    const char *path;             // relativa a la raíz de entrada
+    uint64_t size;
+    int64_t  mtime_ns;
+    uint64_t ino;
+    uint8_t  hash[GSEA_SHA256_LEN];
+    int      keep;                // va al manifiesto que se escribe
+} gsea_manifest_entry_t;
+
+typedef struct {
+    gsea_manifest_entry_t *v;
+    size_t n, cap;
+    size_t *table;                // índice + 1 de cada entrada por ruta; 0 libre
+    size_t tcap;                  // potencia de 2
+    gsea_strarena_t strings;
+    char chain[256];              // cadena de la corrida (línea de header)
+} gsea_manifest_t;
+
+/**
+ * Carga opt->manifest y deja en walk->jobs solo los archivos que cambiaron.
+ * 'next' queda con las entradas del manifiesto nuevo: las de los archivos
+ * salteados ya marcadas, las de los que se van a procesar pendientes.
+ * @return 0 en éxito, -1 en error
+ */
+int gsea_manifest_filter(const gsea_opts_t *opt, gsea_walk_t *walk, gsea_manifest_t *next);
+
+/**
+ * Marca en 'next' los archivos de walk->jobs procesados sin error (ok) y
+ * reemplaza opt->manifest. Llamar antes de liberar 'walk'.
+ * @return 0 en éxito, -1 en error
+ */
+int gsea_manifest_commit(const gsea_opts_t *opt, const gsea_walk_t *walk,
+                         gsea_manifest_t *next);
+
+void gsea_manifest_free(gsea_manifest_t *m);
+
+#endif
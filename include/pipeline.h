@@ -1,9 +1,79 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "gsea.h"
+#include "arena.h"
+#include "codec.h"
+#include "container.h"
+
+struct gsea_budget;
+
+// buffers que un worker reutiliza de un archivo al siguiente: la entrada y
+// el par ping-pong entre etapas (inicializar en cero)
+typedef struct {
+    gsea_buf_t in;
+    gsea_buf_t stage[2];
+    // --mem-budget (ver budget.h): lo cargado por el archivo en curso
+    struct gsea_budget *budget;
+    uint64_t charged, admitted;
+} gsea_worker_t;
+
+void gsea_worker_free(gsea_worker_t *w);
+
+// gsea_buf_reserve sobre un buffer de 'w' que carga al presupuesto lo que crezca
+int gsea_worker_reserve(gsea_worker_t *w, gsea_buf_t *b, size_t n);
 
 // procesa un solo archivo aplicando las operaciones en el orden del CLI
 int gsea_process_file(const gsea_opts_t *opt);
 
+// header de la entrada de un archivo, leído una sola vez y reusado por las
+// decisiones de camino y por quien decodifica (gsea_input_probe)
+typedef struct {
+    int probed;
+    int framed;               // 1 contenedor, 0 no, -1 header inválido
+    gsea_header_t hdr;
+} gsea_input_t;
+
+// lee el header de opt->in_path si la cadena lo necesita (-d/-u primero,
+// --member o --list, y la entrada no es stdin); solo la primera vez
+void gsea_input_probe(const gsea_opts_t *opt, gsea_input_t *in);
+
+// igual que gsea_process_file pero con los buffers del worker 'w'. 'in' es
+// la entrada ya detectada (o a detectar) con gsea_input_probe; NULL: se
+// detecta acá
+int gsea_process_file_ws(const gsea_opts_t *opt, gsea_worker_t *w, gsea_input_t *in);
+
+// 1 si gsea_process_file_ws procesaría este archivo por bloques (contenedor
+// de entrada o de salida); esos archivos se pueden repartir con gsea_blkjob_*.
+// Detecta la entrada en 'in' si hace falta
+int gsea_file_uses_blocks(const gsea_opts_t *opt, gsea_input_t *in);
+
+// aplica la cadena de operaciones de 'opt' sobre un buffer en memoria.
+// *out queda en un buffer nuevo (liberar con free), nunca apunta a 'in'
+int gsea_apply_ops(const gsea_opts_t *opt, const uint8_t *in, size_t n,
+                   uint8_t **out, size_t *outn);
+
+// igual que gsea_apply_ops pero sobre los buffers de 'w': *out apunta a 'in'
+// o a un buffer del worker, válido hasta su próximo uso (no liberar).
+// Los cifrados trabajan en el lugar sobre los buffers que son del worker
+int gsea_apply_ops_ws(const gsea_opts_t *opt, gsea_worker_t *w,
+                      const uint8_t *in, size_t n,
+                      const uint8_t **out, size_t *outn);
+
+// resuelve el codec de cada operación de 'opt'; devuelve la cantidad o -1
+int gsea_steps_from_opts(const gsea_opts_t *opt, gsea_step_t *steps);
+
+// como gsea_apply_ops / gsea_apply_ops_ws pero con la cadena ya resuelta.
+// Si 'limit' no es NULL, un paso que agranda los datos no puede producir más
+// de limit[i] bytes (se rechaza antes de reservar)
+int gsea_apply_steps(const gsea_step_t *steps, int nsteps, const char *key,
+                     const size_t *limit, const uint8_t *in, size_t n,
+                     uint8_t **out, size_t *outn);
+int gsea_apply_steps_ws(const gsea_step_t *steps, int nsteps, const char *key,
+                        const size_t *limit, gsea_worker_t *w,
+                        const uint8_t *in, size_t n,
+                        const uint8_t **out, size_t *outn);
+
 #endif
@@ -0,0 +1,83 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/*
+ * Pool de hilos persistente. Los hilos se crean una vez y atienden tareas de
+ * cualquier llamador: los bloques de --blocks, los workers del modo
+ * directorio, el recorrido y las etapas de --pipeline comparten el pool del
+ * proceso (gsea_pool_shared) en vez de crear hilos en cada llamada. Un
+ * programa que use gsea como biblioteca puede enviar ahí sus propias tareas.
+ *
+ * Las tareas se agrupan: el grupo hace de futuro y gsea_pool_wait espera a
+ * todas las del grupo y devuelve si alguna falló.
+ *
+ * Uso:
+ *     gsea_group_t g;
+ *     gsea_group_init(&g);
+ *     gsea_pool_submit(pool, &g, fn, arg);      // tantas como haga falta
+ *     int rc = gsea_pool_wait(pool, &g);        // -1 si alguna devolvió != 0
+ *     gsea_group_destroy(&g);
+ */
+
+typedef struct gsea_pool gsea_pool_t;
+
+// una tarea: 0 en éxito, distinto de 0 marca el grupo como fallido
+typedef int (*gsea_task_fn)(void *arg);
+
+// tareas pendientes de un grupo (usarlo siempre con el mismo pool)
+typedef struct {
+    size_t pending;
+    int    failed;
+    pthread_cond_t done;
+} gsea_group_t;
+
+void gsea_group_init(gsea_group_t *g);
+void gsea_group_destroy(gsea_group_t *g);
+
+/**
+ * Crea un pool con 'nthreads' hilos (0 = gsea_cpu_count()).
+ * @return el pool, o NULL si no se pudo crear ningún hilo
+ */
+gsea_pool_t *gsea_pool_create(size_t nthreads);
+
+/**
+ * Espera a que terminen todas las tareas encoladas y libera el pool.
+ * No llamar desde una tarea del mismo pool.
+ */
+void gsea_pool_destroy(gsea_pool_t *p);
+
+// pool del proceso: se crea al primer uso con gsea_cpu_count() hilos y vive
+// hasta el final del programa; NULL si no se pudo crear
+gsea_pool_t *gsea_pool_shared(void);
+
+// hilos que tiene el pool ahora
+size_t gsea_pool_threads(gsea_pool_t *p);
+
+/**
+ * Encola una tarea de cómputo. Debe poder terminar aunque ninguna otra tarea
+ * del grupo llegue a correr en paralelo (puede ejecutarla el mismo hilo que
+ * llama a gsea_pool_wait).
+ * @return 0 en éxito, -1 sin memoria
+ */
+int gsea_pool_submit(gsea_pool_t *p, gsea_group_t *g, gsea_task_fn fn, void *arg);
+
+/**
+ * Como gsea_pool_submit para tareas que se bloquean esperando a otras (las
+ * etapas de un pipeline, un worker que espera trabajo): tienen prioridad y
+ * si no hay un hilo libre para cada una se crea uno, que queda en el pool.
+ * @return 0 en éxito, -1 si no se pudo crear el hilo (la tarea no se encola)
+ */
+int gsea_pool_spawn(gsea_pool_t *p, gsea_group_t *g, gsea_task_fn fn, void *arg);
+
+/**
+ * Espera a que terminen las tareas del grupo. Mientras tanto el llamador
+ * ejecuta las del mismo grupo que sigan encoladas, así esperar desde dentro
+ * de otra tarea no bloquea el pool.
+ * @return 0 si todas devolvieron 0, -1 si no
+ */
+int gsea_pool_wait(gsea_pool_t *p, gsea_group_t *g);
+
+#endif
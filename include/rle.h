@@ -4,3 +4,17 @@ int rle_compress(const unsigned char *in, size_t n,
                  unsigned char **out, size_t *outn);
 int rle_decompress(const unsigned char *in, size_t n,
                    unsigned char **out, size_t *outn);
+
+// cota superior de la salida de rle_compress (peor caso: corridas de 1)
+size_t rle_compressed_bound(size_t n);
+// tamaño exacto de la salida de rle_compress (dos bytes por corrida)
+size_t rle_compressed_size(const unsigned char *in, size_t n);
+// comprime en un buffer del llamador de al menos rle_compressed_size() bytes
+int rle_compress_into(const unsigned char *in, size_t n,
+                      unsigned char *out, size_t *outn);
+
+// tamaño exacto de la salida de rle_decompress (suma de los contadores)
+size_t rle_decompressed_size(const unsigned char *in, size_t n);
+// descomprime en un buffer del llamador de al menos rle_decompressed_size() bytes
+int rle_decompress_into(const unsigned char *in, size_t n,
+                        unsigned char *out, size_t *outn);
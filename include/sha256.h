@@ -0,0 +1,33 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * SHA-256 (FIPS 180-4). Lo usa el manifiesto de --manifest para reconocer un
+ * archivo cuyo contenido no cambió aunque sí cambien su mtime o su inodo, y
+ * PBKDF2 para guardar una marca de la clave que no sirva para adivinarla.
+ */
+
+#define GSEA_SHA256_LEN 32
+
+typedef struct {
+    uint32_t h[8];
+    uint64_t len;                 // bytes procesados
+    uint8_t  buf[64];
+    size_t   nbuf;
+} gsea_sha256_t;
+
+void gsea_sha256_init(gsea_sha256_t *s);
+void gsea_sha256_update(gsea_sha256_t *s, const void *data, size_t n);
+void gsea_sha256_final(gsea_sha256_t *s, uint8_t out[GSEA_SHA256_LEN]);
+
+// hash del contenido de un archivo; 0 en éxito, -1 en error (errno)
+int gsea_sha256_file(const char *path, uint8_t out[GSEA_SHA256_LEN]);
+
+// PBKDF2-HMAC-SHA256 (RFC 8018) con 'iters' iteraciones; un solo bloque de salida
+void gsea_pbkdf2_sha256(const void *pass, size_t plen, const uint8_t *salt, size_t slen,
+                        unsigned iters, uint8_t out[GSEA_SHA256_LEN]);
+
+#endif
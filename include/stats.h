@@ -0,0 +1,56 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * --stats[=FILE]: tiempos (reloj monotónico) y bytes de cada etapa, de cada
+ * archivo del modo directorio y del pool, volcados al terminar como un
+ * objeto JSON en FILE o en stderr:
+ *
+ *   elapsed_ms, cpu_user_ms, cpu_sys_ms, peak_rss_kb
+ *   stages[]: name ("read", "write", "lzw compress", "aes decrypt"...),
+ *             calls, bytes_in, bytes_out, ms, mb_s, ratio
+ *   pool:     threads, tasks, task_wait_ms, task_wait_max_ms, task_run_ms,
+ *             utilization
+ *   dir:      workers, busy_ms, alive_ms, utilization, files, bytes_in,
+ *             bytes_out, ratio, wait_ms, wait_max_ms
+ *   files[]:  path, bytes_in, bytes_out, ratio, start_ms, ms, wait_ms,
+ *             thread, ok
+ *
+ * Cada hilo acumula en su propia tabla y las tablas se suman en el reporte,
+ * así medir no agrega contención. Sin --stats cada punto de medida cuesta
+ * una comparación.
+ */
+
+// distinto de cero con --stats; se fija con gsea_stats_init antes de crear hilos
+extern int gsea_stats_on;
+
+/**
+ * Activa las mediciones y programa el reporte para el final del programa
+ * (atexit) en 'path', o en stderr si es NULL.
+ */
+void gsea_stats_init(const char *path);
+
+// reloj monotónico en ns
+int64_t gsea_stats_now(void);
+
+// una pasada por una etapa: name y verb deben vivir todo el programa (verb puede ser NULL)
+void gsea_stats_stage(const char *name, const char *verb,
+                      uint64_t in, uint64_t out, int64_t ns);
+
+// un archivo del modo directorio; start/end de gsea_stats_now, wait en ns
+void gsea_stats_file(const char *path, uint64_t in, uint64_t out,
+                     int64_t start, int64_t end, int64_t wait, int ok);
+
+// un worker del modo directorio: tiempo vivo y tiempo procesando archivos
+void gsea_stats_worker(int64_t alive, int64_t busy);
+
+// una tarea del pool: espera en la cola y ejecución
+void gsea_stats_task(int64_t wait, int64_t run);
+
+// el pool creó un hilo
+void gsea_stats_thread_added(void);
+
+#endif
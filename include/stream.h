@@ -0,0 +1,259 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "gsea.h"
+#include "container.h"
+
+/*
+ * Formato de flujo por bloques (modos --stream, --pipeline y --blocks)
+ *
+ * La entrada se corta en bloques de opt->chunk_size bytes y a cada bloque se le
+ * aplica la cadena completa de operaciones de forma independiente. Tras el
+ * header del contenedor (ver container.h) cada bloque resultante se escribe
+ * como un frame:
+ *
+ *   [u32 stored_len][u32 raw_len][u32 stored_crc][u32 raw_crc][payload]
+ *
+ * (enteros big-endian, igual que el header de Huffman). raw_len es el tamaño
+ * del bloque original antes de la cadena; stored_crc es el CRC32C del payload
+ * y raw_crc el del bloque original (válido si el header trae
+ * GSEA_HDR_RAW_CRC). Al leer se verifica stored_crc antes de decodificar y,
+ * si la cadena se deshace entera, raw_crc sobre el resultado. Un frame con
+ * stored_len == 0 marca el final del flujo. Los contenedores de versión 1
+ * tienen frames de 8 bytes sin CRC y se siguen leyendo.
+ *
+ * Tras el marcador de fin va la tabla de bloques, que permite ubicar cada
+ * frame sin recorrer el flujo:
+ *
+ *   nblocks x [u64 offset del frame][u32 stored_len][u32 raw_len]
+ *   [u64 offset de la tabla][u32 nblocks]["GSBT"]
+ */
+
+#define GSEA_FRAME_HDR    16
+#define GSEA_FRAME_HDR_V1 8
+#define GSEA_INDEX_ENTRY  16
+#define GSEA_INDEX_TAIL   16
+
+static inline size_t gsea_frame_hdr_size(int version){
+    return version >= 2 ? GSEA_FRAME_HDR : GSEA_FRAME_HDR_V1;
+}
+
+// lo que viaja con cada bloque además de sus datos
+typedef struct {
+    uint32_t raw_len;             // tamaño del bloque original
+    uint32_t raw_crc;             // CRC32C del bloque original
+} gsea_blkinfo_t;
+
+// entrada de la tabla de bloques
+typedef struct {
+    uint64_t offset;              // posición del header del frame
+    uint32_t stored_len;
+    uint32_t raw_len;
+} gsea_block_t;
+
+typedef struct {
+    gsea_block_t *v;
+    size_t n, cap;
+    uint64_t pos;                 // offset donde irá el próximo frame
+    size_t frame_hdr;             // tamaño del header de frame de esta versión
+} gsea_index_t;
+
+// lado de entrada: bloques crudos de 'chunk' bytes o frames de un contenedor
+typedef struct {
+    int fd;
+    int framed;
+    gsea_header_t hdr;            // header del contenedor de entrada
+    size_t chunk;
+    // bytes que la detección del contenedor ya consumió de un pipe
+    uint8_t pre[GSEA_HDR_FIXED];
+    size_t pre_len;
+} gsea_source_t;
+
+// lado de salida: frames más tabla de bloques, o bytes crudos en orden
+typedef struct {
+    int fd;
+    int framed;
+    int check_raw;                // la cadena se deshizo entera: len == raw_len
+    int check_crc;                // ... y además raw_crc es válido
+    uint64_t nblocks;
+    uint64_t total_raw;
+    gsea_index_t idx;
+} gsea_sink_t;
+
+// archivo abierto en modo por bloques con su plan resuelto
+typedef struct {
+    gsea_plan_t plan;
+    gsea_source_t src;
+    gsea_sink_t sink;             // fd -1 con --verify: no se escribe nada
+    const char *in_path;
+} gsea_stream_t;
+
+/**
+ * Procesa opt->in_path en bloques de opt->chunk_size bytes.
+ * La memoria máxima queda acotada por chunk_size * (ops_count + 1).
+ *
+ * @return 0 en éxito, -1 en error
+ */
+int gsea_process_stream(const gsea_opts_t *opt);
+
+/**
+ * Igual que gsea_process_stream pero con un hilo por etapa (--pipeline):
+ * lectura, cada operación de ops_order y escritura corren en hilos propios
+ * conectados por colas acotadas productor-único/consumidor-único, de modo
+ * que las etapas se solapan. La salida es idéntica a la del modo secuencial.
+ */
+int gsea_process_stream_pipelined(const gsea_opts_t *opt);
+
+/**
+ * Igual que gsea_process_stream pero repartiendo los bloques entre todos los
+ * cores (--blocks). Los bloques son independientes, así que comprimir y
+ * descomprimir escalan con el número de hilos; el resultado es idéntico al
+ * del modo secuencial. La entrada por frames debe ser un archivo regular.
+ * 'in_hdr' como en gsea_stream_open.
+ */
+int gsea_process_blocks(const gsea_opts_t *opt, const gsea_header_t *in_hdr);
+
+/**
+ * Un archivo repartido en tareas por bloque para un planificador externo
+ * (el pool de directorios). Cualquier hilo toma un bloque y lo procesa; el
+ * que completa el prefijo pendiente escribe en orden los que estén listos,
+ * así no hace falta un hilo escritor y la salida es la del modo secuencial
+ * sin importar cuántos hilos participen.
+ */
+typedef struct gsea_blkjob gsea_blkjob_t;
+
+/**
+ * Abre entrada (archivo regular) y salida y carga la lista de bloques.
+ * 'in_hdr' es el header de la entrada si ya se leyó (ver gsea_stream_open).
+ * 'window' acota los bloques en vuelo por delante del escritor.
+ * @return el trabajo, o NULL en error (no queda nada abierto)
+ */
+gsea_blkjob_t *gsea_blkjob_open(const gsea_opts_t *opt, const gsea_header_t *in_hdr,
+                                size_t window);
+
+// entrada que no es un archivo: 'size' bytes que se leen con read(ctx, ...)
+typedef struct {
+    uint64_t size;
+    // n bytes desde off; 0 en éxito. Se llama desde varios hilos a la vez
+    int (*read)(void *ctx, uint8_t *buf, size_t n, uint64_t off);
+    void *ctx;
+    // bloques de tamaño variable: el bloque i es [starts[i], starts[i+1]);
+    // NULL = bloques de opt->chunk_size (ninguno puede superar GSEA_MAX_CHUNK)
+    const uint64_t *starts;
+    size_t nblocks;
+} gsea_vsource_t;
+
+/**
+ * Como gsea_blkjob_open pero la entrada es 'vs' (por ejemplo varios archivos
+ * concatenados). La cadena de opt solo puede codificar (-c/-e) y la salida
+ * es siempre un contenedor; 'hdr_flags' se agregan a los flags del header.
+ */
+gsea_blkjob_t *gsea_blkjob_open_virtual(const gsea_opts_t *opt, size_t window,
+                                        const gsea_vsource_t *vs, uint8_t hdr_flags);
+size_t gsea_blkjob_blocks(const gsea_blkjob_t *j);
+/**
+ * Reserva el próximo bloque. Con la ventana llena espera si 'wait'.
+ * @return 1 si tomó el bloque *i, 0 si la ventana está llena (sin 'wait'),
+ *         -1 si no quedan bloques por tomar
+ */
+int gsea_blkjob_take(gsea_blkjob_t *j, int wait, size_t *i);
+/**
+ * Procesa el bloque i tomado con gsea_blkjob_take y escribe lo que esté listo.
+ * @return 1 si con esta llamada terminó el archivo (llamar a
+ *         gsea_blkjob_finish), 0 si no
+ */
+int gsea_blkjob_run(gsea_blkjob_t *j, size_t i);
+// cierra entrada y salida; 0 si se escribieron todos los bloques
+int gsea_blkjob_finish(gsea_blkjob_t *j);
+// procesa todos los bloques con hasta 'nthreads' hilos del pool compartido
+// (el llamador incluido) y termina el trabajo; 0 en éxito
+int gsea_blkjob_process(gsea_blkjob_t *j, size_t nthreads);
+// libera el trabajo; si no se terminó, cierra con error
+void gsea_blkjob_free(gsea_blkjob_t *j);
+
+/**
+ * Extrae el rango [range_off, range_off + range_len) del original de un
+ * contenedor (--range). Con la tabla de bloques solo se leen y decodifican
+ * los bloques que cubren el rango. Sin -d/-u se deshace la cadena registrada.
+ */
+int gsea_process_range(const gsea_opts_t *opt);
+
+/**
+ * Abre entrada y salida, detecta si la entrada es un contenedor, resuelve el
+ * plan y escribe el header de salida si corresponde. Si el llamador ya leyó
+ * el header del contenedor de entrada lo pasa en 'in_hdr' y no se vuelve a
+ * leer; con NULL se detecta.
+ * @return 0 en éxito, -1 en error (no queda nada abierto)
+ */
+int gsea_stream_open(const gsea_opts_t *opt, const gsea_header_t *in_hdr, gsea_stream_t *st);
+// bucle secuencial sobre un flujo ya abierto; lo cierra al terminar
+int gsea_stream_run(const gsea_opts_t *opt, gsea_stream_t *st);
+// cierra el flujo; si rc == 0 escribe el final del contenedor. Devuelve rc final
+int gsea_stream_close(gsea_stream_t *st, int rc);
+
+/**
+ * Siguiente bloque de la entrada. *buf queda en un buffer nuevo (free).
+ * @return 1 si leyó un bloque, 0 al final, -1 en error
+ */
+int gsea_source_next(gsea_source_t *src, uint8_t **buf, size_t *len,
+                     gsea_blkinfo_t *info);
+// escribe un bloque ya transformado; 0 en éxito, -1 en error
+int gsea_sink_put(gsea_sink_t *sink, const uint8_t *data, size_t len,
+                  const gsea_blkinfo_t *info);
+/**
+ * Si la cadena se deshizo entera, comprueba que el bloque decodificado sea el
+ * original (tamaño y CRC32C). Se llama donde se decodifica, así en --blocks
+ * la verificación también corre en paralelo.
+ * @return 0 si coincide o no hay nada que comprobar, -1 si no
+ */
+int gsea_sink_check(const gsea_sink_t *sink, const uint8_t *data, size_t len,
+                    const gsea_blkinfo_t *info);
+
+// registra un frame de stored_len bytes escrito en idx->pos
+int gsea_index_add(gsea_index_t *idx, uint32_t stored_len, uint32_t raw_len);
+// escribe el marcador de fin, la tabla y el trailer
+int gsea_index_finish(int fd, const gsea_index_t *idx);
+/**
+ * Carga la tabla de bloques de un contenedor cuyo primer frame está en
+ * 'start'. Si el archivo no tiene tabla la reconstruye recorriendo los headers.
+ * @return 0 en éxito, -1 en error
+ */
+int gsea_index_read(int fd, uint64_t start, size_t frame_hdr, gsea_index_t *idx);
+void gsea_index_free(gsea_index_t *idx);
+
+// lee exactamente n bytes salvo EOF; devuelve los bytes leídos o -1 en error
+ssize_t gsea_read_full(int fd, uint8_t *buf, size_t n);
+// "-" como ruta: stdin para la entrada, stdout para la salida
+static inline int gsea_is_stdio(const char *path){
+    return path && path[0] == '-' && path[1] == '\0';
+}
+// open() que entiende "-"; -1 en error (errno)
+int gsea_open_in(const char *path);
+int gsea_open_out(const char *path);
+// close() que no cierra stdin/stdout
+int gsea_close_fd(int fd);
+// pread de n bytes completos; 0 en éxito, -1 en error o EOF prematuro
+int gsea_pread_full(int fd, uint8_t *buf, size_t n, uint64_t off);
+// escribe los n bytes completos; 0 en éxito, -1 en error
+int gsea_write_full(int fd, const uint8_t *buf, size_t n);
+
+// escribe un frame (stored_len == 0 escribe el marcador de fin)
+int gsea_frame_write(int fd, const uint8_t *payload, uint32_t stored_len,
+                     const gsea_blkinfo_t *info);
+/**
+ * Lee el siguiente frame del contenedor de header 'h' y verifica el CRC del
+ * payload. Un frame más grande de lo que la cadena de 'h' puede producir con
+ * un bloque de chunk_size bytes se rechaza antes de reservar memoria.
+ * *payload queda en un buffer nuevo (liberar con free).
+ * @return 1 si leyó un frame, 0 al encontrar el marcador de fin, -1 en error
+ */
+int gsea_frame_read(int fd, const gsea_header_t *h, uint8_t **payload,
+                    uint32_t *stored_len, gsea_blkinfo_t *info);
+// igual que gsea_frame_read pero con pread del bloque b de la tabla
+int gsea_frame_load(int fd, const gsea_header_t *h, const gsea_block_t *b,
+                    uint8_t **payload, gsea_blkinfo_t *info);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/io_uring.h>
+#include "gsea.h"
+#include "walk.h"
+
+/*
+ * Envoltorio mínimo de io_uring sobre las syscalls (sin liburing): un anillo
+ * de envío (SQ) y uno de completados (CQ) mapeados en memoria compartida con
+ * el kernel. Lo usa un solo hilo.
+ */
+typedef struct {
+    int fd;
+    // SQ
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_entries;
+    unsigned sqe_tail;            // SQEs preparados, aún no publicados
+    // CQ
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    // mapeos
+    void  *sq_ptr, *cq_ptr;
+    size_t sq_sz, cq_sz, sqes_sz;
+} gsea_uring_t;
+
+/**
+ * Crea el anillo y verifica que el kernel soporte OPENAT, READ, WRITE y CLOSE
+ *
+ * @return       0 en éxito, -1 si io_uring no está disponible (errno indica la causa)
+ */
+int gsea_uring_init(gsea_uring_t *r, unsigned entries);
+void gsea_uring_exit(gsea_uring_t *r);
+
+/**
+ * Próximo SQE libre, ya puesto en cero
+ *
+ * @return       NULL si la cola de envío está llena (llamar a gsea_uring_submit)
+ */
+struct io_uring_sqe *gsea_uring_sqe(gsea_uring_t *r);
+
+/**
+ * Publica los SQEs preparados y espera hasta 'wait_nr' completados
+ *
+ * @return       0 en éxito, -1 en error
+ */
+int gsea_uring_submit(gsea_uring_t *r, unsigned wait_nr);
+
+/**
+ * Toma un completado si hay alguno
+ *
+ * @return       1 si se obtuvo uno, 0 si la cola está vacía
+ */
+int gsea_uring_cqe(gsea_uring_t *r, uint64_t *user_data, int32_t *res);
+
+/**
+ * Procesa un lote de archivos con io_uring: un hilo de E/S agrupa aperturas,
+ * lecturas y escrituras y los workers de cómputo (uno por core) solo aplican
+ * la cadena de operaciones
+ *
+ * @return       0 si todo salió bien, -1 si falló algún archivo,
+ *               -2 si io_uring no está disponible (no se procesó nada)
+ */
+int gsea_dir_uring(const gsea_opts_t *opt, gsea_file_job_t *jobs, size_t count);
+
+#endif
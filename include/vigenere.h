@@ -12,4 +12,14 @@ int vig_decrypt(const uint8_t *in, size_t n,
                 const uint8_t *key, size_t klen,
                 uint8_t **out, size_t *outn);
 
+// variantes que escriben en un buffer del llamador de al menos n bytes
+// (out puede ser igual a in para transformar en el lugar)
+int vig_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out);
+
+int vig_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out);
+
 #endif
@@ -0,0 +1,49 @@
+#ifndef WALK_H
+#define WALK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+// un archivo del lote de directorio
+typedef struct {
+    const char *in_path;
+    const char *out_path;         // NULL si no hay salida (--verify)
+    uint64_t size;                // tamaño visto al listar el directorio
+    int64_t  mtime_ns;            // mtime e inodo vistos al listar (--manifest)
+    uint64_t ino;
+    int      ok;                  // lo marca quien lo procesó sin error
+} gsea_file_job_t;
+
+// resultado de recorrer un árbol: los archivos regulares encontrados
+typedef struct {
+    gsea_file_job_t *jobs;
+    size_t count;
+    gsea_strarena_t strings;      // las rutas de jobs, liberadas juntas
+    size_t dirs;                  // directorios recorridos (incluida la raíz)
+    size_t skipped_dirs;          // subdirectorios omitidos por no ser recursivo
+    int    failed;                // algún directorio no se pudo leer o crear
+} gsea_walk_t;
+
+/**
+ * Lista los archivos regulares de in_root. Con 'recursive' también los de
+ * los subdirectorios: varios hilos expanden directorios desde una pila
+ * compartida, así que listar no se vuelve el cuello de botella en discos
+ * rápidos o sistemas de archivos de red. Si out_root no es NULL cada archivo
+ * lleva su ruta espejo debajo de out_root y los subdirectorios de salida se
+ * crean durante el recorrido (out_root ya debe existir).
+ *
+ * Un solo recorrido con getdents64: el tipo sale de d_type y solo se hace
+ * fstatat por archivo (para el tamaño) o si el fs no informa el tipo. Las
+ * rutas se guardan juntas en w->strings, sin un malloc por archivo.
+ *
+ * Los enlaces simbólicos a archivos se siguen; a directorios no (evita ciclos).
+ * Un directorio ilegible se informa por stderr y marca 'failed', pero el
+ * recorrido sigue con el resto.
+ *
+ * @return       0 en éxito (ver w->failed), -1 si no se pudo recorrer
+ */
+int gsea_walk(const char *in_root, const char *out_root, int recursive, gsea_walk_t *w);
+void gsea_walk_free(gsea_walk_t *w);
+
+#endif
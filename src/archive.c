@@ -0,0 +1,594 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "gsea.h"
+#include "archive.h"
+#include "container.h"
+#include "stream.h"
+#include "walk.h"
+#include "cpus.h"
+#include "pool.h"
+#include "log.h"
+
+#define MEMBER_FIXED 18           // [u64 offset][u64 tamaño][u16 largo del nombre]
+#define INDEX_TAIL   8            // [u64 largo del índice]
+
+typedef struct {
+    const char *path;             // de dónde se lee al crear; NULL al extraer
+    const char *name;             // relativo a la raíz
+    uint64_t off, size;           // posición en el flujo original
+} member_t;
+
+static void put_u16(uint8_t *p, uint16_t v){
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t *p, uint32_t v){
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (24 - 8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v){
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p){
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint64_t get_u64(const uint8_t *p){
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = v << 8 | p[i];
+    return v;
+}
+
+// último miembro con off <= pos (los de tamaño 0 comparten offset con el
+// siguiente, así que el que contiene pos siempre es el último)
+static size_t find_member(const member_t *m, size_t n, uint64_t pos){
+    size_t lo = 0, hi = n;
+    while (hi - lo > 1){
+        size_t mid = lo + (hi - lo) / 2;
+        if (m[mid].off <= pos) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// primer bloque cuyo rango [start[i], start[i+1]) contiene 'off'
+static size_t find_block(const uint64_t *start, size_t n, uint64_t off){
+    size_t lo = 0, hi = n;
+    while (hi - lo > 1){
+        size_t mid = lo + (hi - lo) / 2;
+        if (start[mid] <= off) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int member_cmp(const void *a, const void *b){
+    return strcmp(((const member_t *)a)->name, ((const member_t *)b)->name);
+}
+
+typedef struct {
+    member_t *m;
+    size_t n;
+    uint64_t data_end;            // fin de los datos; después va el índice
+    uint8_t *index;               // índice serializado, con el largo al final
+} pack_t;
+
+// gsea_vsource_t: arma el flujo original a partir de los archivos
+static int pack_read(void *ctx, uint8_t *buf, size_t n, uint64_t off){
+    const pack_t *p = ctx;
+    while (n > 0){
+        if (off >= p->data_end){
+            memcpy(buf, p->index + (off - p->data_end), n);
+            return 0;
+        }
+        const member_t *m = &p->m[find_member(p->m, p->n, off)];
+        uint64_t left = m->off + m->size - off;
+        size_t take = left < n ? (size_t)left : n;
+
+        // un open por pedazo: los archivos chicos caen enteros en un bloque
+        int fd = open(m->path, O_RDONLY);
+        if (fd < 0){
+            fprintf(stderr, "open '%s': %s\n", m->path, strerror(errno));
+            return -1;
+        }
+        int rc = gsea_pread_full(fd, buf, take, off - m->off);
+        close(fd);
+        if (rc != 0){
+            fprintf(stderr, "error: '%s' cambió de tamaño mientras se empaquetaba\n", m->path);
+            return -1;
+        }
+        buf += take;
+        off += take;
+        n -= take;
+    }
+    return 0;
+}
+
+int gsea_archive_create(const gsea_opts_t *opt){
+    for (int i = 0; i < opt->ops_count; i++){
+        if (opt->ops_order[i] == 'd' || opt->ops_order[i] == 'u'){
+            fprintf(stderr, "error: --archive solo admite -c y -e\n");
+            return -1;
+        }
+    }
+    if (opt->ops_count == 0){
+        fprintf(stderr, "error: --archive necesita -c y/o -e\n");
+        return -1;
+    }
+
+    gsea_walk_t walk;
+    if (gsea_walk(opt->in_path, NULL, opt->recursive, &walk) != 0){
+        fprintf(stderr, "no se pudo recorrer '%s'\n", opt->in_path);
+        return -1;
+    }
+    if (walk.skipped_dirs > 0){
+        GSEA_LOG(GSEA_LOG_WARN, "archive", "%zu subdirectorios omitidos (usar -r para incluirlos)",
+                 walk.skipped_dirs);
+    }
+
+    pack_t pk = { 0 };
+    int rc = -1;
+    pk.n = walk.count;
+    pk.m = malloc((pk.n ? pk.n : 1) * sizeof(*pk.m));
+    if (!pk.m){
+        perror("malloc miembros");
+        goto out;
+    }
+
+    size_t lroot = strlen(opt->in_path);
+    size_t skip = lroot + (lroot > 0 && opt->in_path[lroot - 1] != '/');
+    size_t index_len = 4;
+    for (size_t i = 0; i < pk.n; i++){
+        member_t *m = &pk.m[i];
+        m->path = walk.jobs[i].in_path;
+        m->name = m->path + skip;
+        m->size = walk.jobs[i].size;
+        size_t ln = strlen(m->name);
+        if (ln > UINT16_MAX){
+            fprintf(stderr, "error: nombre demasiado largo: '%s'\n", m->path);
+            goto out;
+        }
+        index_len += MEMBER_FIXED + ln;
+    }
+    // orden estable entre corridas: la salida no depende del recorrido
+    qsort(pk.m, pk.n, sizeof(*pk.m), member_cmp);
+
+    uint64_t pos = 0;
+    for (size_t i = 0; i < pk.n; i++){
+        pk.m[i].off = pos;
+        pos += pk.m[i].size;
+    }
+    pk.data_end = pos;
+
+    pk.index = malloc(index_len + INDEX_TAIL);
+    if (!pk.index){
+        perror("malloc índice");
+        goto out;
+    }
+    uint8_t *q = pk.index;
+    put_u32(q, (uint32_t)pk.n);
+    q += 4;
+    for (size_t i = 0; i < pk.n; i++){
+        size_t ln = strlen(pk.m[i].name);
+        put_u64(q, pk.m[i].off);
+        put_u64(q + 8, pk.m[i].size);
+        put_u16(q + 16, (uint16_t)ln);
+        memcpy(q + MEMBER_FIXED, pk.m[i].name, ln);
+        q += MEMBER_FIXED + ln;
+    }
+    put_u64(q, index_len);
+
+    gsea_vsource_t vs = { pk.data_end + index_len + INDEX_TAIL, pack_read, &pk, NULL, 0 };
+    size_t nthreads = (size_t)gsea_jobs(opt);
+    gsea_blkjob_t *j = gsea_blkjob_open_virtual(opt, nthreads * 2, &vs, GSEA_HDR_ARCHIVE);
+    if (!j) goto out;
+    if (nthreads > gsea_blkjob_blocks(j)) nthreads = gsea_blkjob_blocks(j);
+    rc = gsea_blkjob_process(j, nthreads);
+    gsea_blkjob_free(j);
+
+    if (rc == 0){
+        GSEA_LOG(GSEA_LOG_INFO, "archive", "%zu miembros, %llu bytes", pk.n,
+                 (unsigned long long)pk.data_end);
+    }
+    if (walk.failed) rc = -1;
+out:
+    free(pk.index);
+    free(pk.m);
+    gsea_walk_free(&walk);
+    return rc;
+}
+
+typedef struct {
+    const gsea_opts_t *opt;
+    int fd;
+    gsea_plan_t plan;
+    gsea_sink_t check;            // solo para gsea_sink_check
+    gsea_index_t idx;
+    uint64_t *start;              // offset original de cada bloque, idx.n + 1
+    member_t *m;
+    size_t n;
+    uint64_t data_end;
+    char *names;                  // los nombres, terminados en '\0'
+    const char *root;             // directorio de salida
+    size_t next;                  // próximo bloque a extraer (atómico)
+} unpack_t;
+
+// decodifica el bloque b y comprueba que sea el original
+static int unpack_block(const unpack_t *u, size_t b, uint8_t **res, size_t *reslen){
+    const gsea_block_t *blk = &u->idx.v[b];
+    uint8_t *in = NULL;
+    gsea_blkinfo_t info;
+    if (gsea_frame_load(u->fd, &u->plan.in_hdr, blk, &in, &info) != 0) return -1;
+    int rc = gsea_plan_apply(&u->plan, u->opt, info.raw_len, 0, u->plan.nsteps,
+                             in, blk->stored_len, res, reslen);
+    free(in);
+    if (rc != 0) return -1;
+    if (gsea_sink_check(&u->check, *res, *reslen, &info) != 0 ||
+        *reslen != blk->raw_len){
+        free(*res);
+        *res = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// [off, off + len) del original: a 'buf' si no es NULL, si no al fd 'out'
+static int unpack_range(const unpack_t *u, uint64_t off, uint64_t len,
+                        uint8_t *buf, int out){
+    uint64_t end = off + len;
+    for (size_t b = len > 0 ? find_block(u->start, u->idx.n, off) : u->idx.n;
+         b < u->idx.n && u->start[b] < end; b++){
+        uint8_t *res = NULL;
+        size_t reslen = 0;
+        if (unpack_block(u, b, &res, &reslen) != 0) return -1;
+        uint64_t from = off > u->start[b] ? off - u->start[b] : 0;
+        uint64_t to = end < u->start[b + 1] ? end - u->start[b] : reslen;
+        int rc = 0;
+        if (buf){
+            memcpy(buf + (u->start[b] + from - off), res + from, (size_t)(to - from));
+        } else if (gsea_write_full(out, res + from, (size_t)(to - from)) != 0){
+            perror("write");
+            rc = -1;
+        }
+        free(res);
+        if (rc != 0) return -1;
+    }
+    return 0;
+}
+
+// lee y valida el índice central del final del flujo
+static int unpack_index(unpack_t *u){
+    uint64_t total = u->start[u->idx.n];
+    uint8_t tail[INDEX_TAIL];
+    if (total < 4 + INDEX_TAIL ||
+        unpack_range(u, total - INDEX_TAIL, INDEX_TAIL, tail, -1) != 0){
+        fprintf(stderr, "error: '%s': índice del archivo dañado\n", u->opt->in_path);
+        return -1;
+    }
+    uint64_t index_len = get_u64(tail);
+    if (index_len < 4 || index_len > total - INDEX_TAIL || index_len > SIZE_MAX / 2){
+        fprintf(stderr, "error: '%s': índice del archivo dañado\n", u->opt->in_path);
+        return -1;
+    }
+    u->data_end = total - INDEX_TAIL - index_len;
+
+    uint8_t *ix = malloc((size_t)index_len);
+    if (!ix){
+        perror("malloc índice");
+        return -1;
+    }
+    if (unpack_range(u, u->data_end, index_len, ix, -1) != 0){
+        free(ix);
+        return -1;
+    }
+
+    // cada nombre ocupa lo mismo que en el índice, más su '\0'
+    u->n = get_u32(ix);
+    if (u->n > (index_len - 4) / MEMBER_FIXED) goto bad;
+    u->m = malloc((u->n ? u->n : 1) * sizeof(*u->m));
+    u->names = malloc((size_t)index_len);
+    if (!u->m || !u->names){
+        perror("malloc índice");
+        free(ix);
+        return -1;
+    }
+    const uint8_t *p = ix + 4, *end = ix + index_len;
+    char *name = u->names;
+    uint64_t pos = 0;
+    for (size_t i = 0; i < u->n; i++){
+        if ((size_t)(end - p) < MEMBER_FIXED) goto bad;
+        member_t *m = &u->m[i];
+        m->path = NULL;
+        m->off = get_u64(p);
+        m->size = get_u64(p + 8);
+        size_t ln = get_u16(p + 16);
+        p += MEMBER_FIXED;
+        if ((size_t)(end - p) < ln) goto bad;
+        // contiguos y en orden: es lo que permite buscarlos por offset
+        if (m->off != pos || m->size > u->data_end - pos) goto bad;
+        pos += m->size;
+        memcpy(name, p, ln);
+        name[ln] = '\0';
+        m->name = name;
+        name += ln + 1;
+        p += ln;
+    }
+    if (p != end || pos != u->data_end) goto bad;
+    free(ix);
+    return 0;
+
+bad:
+    fprintf(stderr, "error: '%s': índice del archivo dañado\n", u->opt->in_path);
+    free(ix);
+    return -1;
+}
+
+// nombre relativo sin componentes vacíos, "." ni "..": no escapa de la raíz
+static int safe_name(const char *s){
+    if (*s == '\0' || *s == '/') return 0;
+    for (const char *c = s; ; ){
+        const char *e = strchr(c, '/');
+        size_t l = e ? (size_t)(e - c) : strlen(c);
+        if (l == 0 || (l == 1 && c[0] == '.') || (l == 2 && c[0] == '.' && c[1] == '.')){
+            return 0;
+        }
+        if (!e) return 1;
+        c = e + 1;
+    }
+}
+
+static int member_path(const unpack_t *u, const member_t *m, char *buf){
+    int l = snprintf(buf, PATH_MAX, "%s/%s", u->root, m->name);
+    if (l < 0 || l >= PATH_MAX){
+        fprintf(stderr, "error: ruta demasiado larga: '%s'\n", m->name);
+        return -1;
+    }
+    return 0;
+}
+
+// crea los directorios intermedios de 'path' a partir de 'from'
+static int make_parents(char *path, size_t from){
+    for (char *s = path + from; (s = strchr(s, '/')); s++){
+        *s = '\0';
+        int rc = mkdir(path, 0755);
+        if (rc != 0 && errno == EEXIST){
+            struct stat st;
+            rc = stat(path, &st) == 0 && S_ISDIR(st.st_mode) ? 0 : -1;
+            if (rc != 0) errno = ENOTDIR;
+        }
+        if (rc != 0){
+            fprintf(stderr, "mkdir '%s': %s\n", path, strerror(errno));
+            *s = '/';
+            return -1;
+        }
+        *s = '/';
+    }
+    return 0;
+}
+
+static int pwrite_full(int fd, const uint8_t *buf, size_t n, uint64_t off){
+    size_t done = 0;
+    while (done < n){
+        ssize_t w = pwrite(fd, buf + done, n - done, (off_t)(off + done));
+        if (w < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += (size_t)w;
+    }
+    return 0;
+}
+
+// escribe la parte de m que cae en el bloque b (ya decodificado en res)
+static int unpack_piece(const unpack_t *u, size_t b, const member_t *m,
+                        const uint8_t *res){
+    uint64_t from = m->off > u->start[b] ? m->off : u->start[b];
+    uint64_t to = m->off + m->size < u->start[b + 1] ? m->off + m->size : u->start[b + 1];
+    char path[PATH_MAX];
+    if (member_path(u, m, path) != 0) return -1;
+
+    // entero en este bloque: se crea acá; si no, ya lo truncó el hilo principal
+    int whole = from == m->off && to == m->off + m->size;
+    int fd = whole ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+                   : open(path, O_WRONLY);
+    if (fd < 0){
+        fprintf(stderr, "open '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+    int rc = whole ? gsea_write_full(fd, res + (from - u->start[b]), (size_t)(to - from))
+                   : pwrite_full(fd, res + (from - u->start[b]), (size_t)(to - from),
+                                 from - m->off);
+    if (rc != 0) fprintf(stderr, "write '%s': %s\n", path, strerror(errno));
+    if (close(fd) != 0 && rc == 0){
+        fprintf(stderr, "close '%s': %s\n", path, strerror(errno));
+        rc = -1;
+    }
+    return rc;
+}
+
+// tarea del pool: toma bloques hasta que no quede ninguno
+static int unpack_worker(void *ptr){
+    unpack_t *u = ptr;
+    int rc = 0;
+    for (;;){
+        size_t b = __atomic_fetch_add(&u->next, 1, __ATOMIC_RELAXED);
+        if (b >= u->idx.n || u->start[b] >= u->data_end) break;
+
+        uint8_t *res = NULL;
+        size_t reslen = 0;
+        if (unpack_block(u, b, &res, &reslen) != 0){
+            rc = -1;
+            continue;
+        }
+        for (size_t i = find_member(u->m, u->n, u->start[b]);
+             i < u->n && u->m[i].off < u->start[b + 1]; i++){
+            if (u->m[i].size == 0 || u->m[i].off + u->m[i].size <= u->start[b]) continue;
+            if (unpack_piece(u, b, &u->m[i], res) != 0) rc = -1;
+        }
+        free(res);
+    }
+    return rc;
+}
+
+static int unpack_all(unpack_t *u){
+    u->root = u->opt->out_path;
+    if (gsea_is_stdio(u->root)){
+        fprintf(stderr, "error: un archivo de --archive se extrae a un directorio "
+                        "(usar --member para un solo miembro)\n");
+        return -1;
+    }
+    if (fs_ensure_dir(u->root) != 0){
+        fprintf(stderr, "error: la salida '%s' debe ser un directorio\n", u->root);
+        return -1;
+    }
+
+    // directorios y archivos que no se crean dentro de un único bloque
+    size_t lroot = strlen(u->root);
+    char path[PATH_MAX];
+    for (size_t i = 0; i < u->n; i++){
+        const member_t *m = &u->m[i];
+        if (!safe_name(m->name)){
+            fprintf(stderr, "error: nombre de miembro inválido: '%s'\n", m->name);
+            return -1;
+        }
+        if (member_path(u, m, path) != 0 || make_parents(path, lroot + 1) != 0) return -1;
+        if (m->size > 0 &&
+            find_block(u->start, u->idx.n, m->off) ==
+            find_block(u->start, u->idx.n, m->off + m->size - 1)){
+            continue;
+        }
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0){
+            fprintf(stderr, "open '%s': %s\n", path, strerror(errno));
+            return -1;
+        }
+        close(fd);
+    }
+
+    // los bloques son independientes: cada hilo decodifica uno y escribe los
+    // pedazos de miembros que contiene
+    size_t nthreads = (size_t)gsea_jobs(u->opt);
+    if (nthreads > u->idx.n) nthreads = u->idx.n;
+    gsea_pool_t *pool = gsea_pool_shared();
+    gsea_group_t g;
+    gsea_group_init(&g);
+    for (size_t i = 1; pool && i < nthreads; i++){
+        if (gsea_pool_submit(pool, &g, unpack_worker, u) != 0) break;
+    }
+    int rc = unpack_worker(u);
+    if (pool && gsea_pool_wait(pool, &g) != 0) rc = -1;
+    gsea_group_destroy(&g);
+
+    if (rc == 0){
+        GSEA_LOG(GSEA_LOG_INFO, "archive", "%zu miembros extraídos en %s", u->n, u->root);
+    }
+    return rc;
+}
+
+static int unpack_member(const unpack_t *u){
+    for (size_t i = 0; i < u->n; i++){
+        const member_t *m = &u->m[i];
+        if (strcmp(m->name, u->opt->member) != 0) continue;
+        int fd = gsea_open_out(u->opt->out_path);
+        if (fd < 0){
+            perror("open out");
+            return -1;
+        }
+        int rc = unpack_range(u, m->off, m->size, NULL, fd);
+        if (gsea_close_fd(fd) != 0 && rc == 0){
+            perror("close out");
+            rc = -1;
+        }
+        return rc;
+    }
+    fprintf(stderr, "error: '%s' no está en el archivo '%s'\n",
+            u->opt->member, u->opt->in_path);
+    return -1;
+}
+
+int gsea_archive_extract(const gsea_opts_t *opt, const gsea_header_t *in_hdr){
+    unpack_t u;
+    memset(&u, 0, sizeof(u));
+    u.opt = opt;
+    int explicit = opt->member || opt->list;
+
+    u.fd = open(opt->in_path, O_RDONLY);
+    if (u.fd < 0){
+        perror("open in");
+        return -1;
+    }
+    gsea_header_t hdr;
+    int framed = 1;
+    if (in_hdr){
+        hdr = *in_hdr;
+    } else {
+        uint8_t pre[GSEA_HDR_FIXED];
+        size_t pre_len;
+        framed = gsea_container_probe(u.fd, &hdr, pre, &pre_len);
+    }
+    if (framed != 1 || !(hdr.flags & GSEA_HDR_ARCHIVE)){
+        close(u.fd);
+        if (!explicit) return framed < 0 ? -1 : 1;
+        fprintf(stderr, "error: '%s' no es un archivo de --archive\n", opt->in_path);
+        return -1;
+    }
+    size_t chunk = hdr.chunk_size ? hdr.chunk_size : GSEA_DEFAULT_CHUNK;
+    if (gsea_plan_build(opt, 1, &hdr, chunk, &u.plan) != 0){
+        close(u.fd);
+        return -1;
+    }
+    if (u.plan.framed_out){
+        close(u.fd);
+        if (!explicit) return 1;      // deshacer una parte da otro contenedor
+        fprintf(stderr, "error: --member/--list requieren la cadena inversa completa\n");
+        return -1;
+    }
+    u.check.check_raw = 1;
+    u.check.check_crc = (hdr.flags & GSEA_HDR_RAW_CRC) != 0;
+
+    int rc = -1;
+    if (gsea_index_read(u.fd, gsea_header_size(&hdr), gsea_frame_hdr_size(hdr.version),
+                        &u.idx) != 0){
+        close(u.fd);
+        return -1;
+    }
+    u.start = malloc((u.idx.n + 1) * sizeof(*u.start));
+    if (!u.start){
+        perror("malloc");
+        goto out;
+    }
+    u.start[0] = 0;
+    for (size_t i = 0; i < u.idx.n; i++) u.start[i + 1] = u.start[i] + u.idx.v[i].raw_len;
+    if (unpack_index(&u) != 0) goto out;
+
+    if (opt->list){
+        for (size_t i = 0; i < u.n; i++){
+            printf("%12llu  %s\n", (unsigned long long)u.m[i].size, u.m[i].name);
+        }
+        rc = 0;
+    } else if (opt->member){
+        rc = unpack_member(&u);
+    } else {
+        rc = unpack_all(&u);
+    }
+out:
+    free(u.names);
+    free(u.m);
+    free(u.start);
+    gsea_index_free(&u.idx);
+    close(u.fd);
+    return rc;
+}
@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "arena.h"
+
+#define ARENA_MIN_CHUNK (1u << 20)
+#define ARENA_ALIGN     16
+
+typedef struct chunk {
+    struct chunk *next;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGN) unsigned char data[];
+} chunk_t;
+
+struct gsea_arena {
+    chunk_t *head;
+    chunk_t *cur;
+};
+
+static pthread_key_t arena_key;
+static pthread_once_t arena_once = PTHREAD_ONCE_INIT;
+
+static void arena_destroy(void *ptr){
+    gsea_arena_t *a = ptr;
+    chunk_t *c = a->head;
+    while (c){
+        chunk_t *next = c->next;
+        free(c);
+        c = next;
+    }
+    free(a);
+}
+
+static void arena_key_init(void){
+    pthread_key_create(&arena_key, arena_destroy);
+}
+
+gsea_arena_t *gsea_arena_thread(void){
+    pthread_once(&arena_once, arena_key_init);
+    gsea_arena_t *a = pthread_getspecific(arena_key);
+    if (!a){
+        a = calloc(1, sizeof(*a));
+        if (!a) return NULL;
+        pthread_setspecific(arena_key, a);
+    }
+    return a;
+}
+
+static chunk_t *chunk_new(size_t need){
+    size_t size = need > ARENA_MIN_CHUNK ? need : ARENA_MIN_CHUNK;
+    chunk_t *c = malloc(sizeof(*c) + size);
+    if (!c) return NULL;
+    c->next = NULL;
+    c->size = size;
+    c->used = 0;
+    return c;
+}
+
+void *gsea_arena_alloc(gsea_arena_t *a, size_t n){
+    if (!a) return NULL;
+    n = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (!a->head){
+        a->head = a->cur = chunk_new(n);
+        if (!a->head) return NULL;
+    }
+
+    chunk_t *c = a->cur;
+    if (c->size - c->used < n){
+        // reutilizar el siguiente chunk si alcanza; si no, intercalar uno nuevo
+        chunk_t *next = c->next;
+        if (next && next->size >= n){
+            next->used = 0;
+        } else {
+            chunk_t *nc = chunk_new(n);
+            if (!nc) return NULL;
+            nc->next = next;
+            c->next = nc;
+            next = nc;
+        }
+        a->cur = c = next;
+    }
+
+    void *p = c->data + c->used;
+    c->used += n;
+    return p;
+}
+
+gsea_arena_mark_t gsea_arena_mark(gsea_arena_t *a){
+    gsea_arena_mark_t m = { NULL, 0 };
+    if (a && a->cur){
+        m.chunk = a->cur;
+        m.used = a->cur->used;
+    }
+    return m;
+}
+
+void gsea_arena_release(gsea_arena_t *a, gsea_arena_mark_t m){
+    if (!a || !a->head) return;
+    if (!m.chunk){
+        // marca tomada con la arena vacía: volver al principio
+        a->cur = a->head;
+        a->cur->used = 0;
+        return;
+    }
+    a->cur = m.chunk;
+    a->cur->used = m.used;
+}
+
+#define STRARENA_CHUNK (64u << 10)
+
+struct gsea_strchunk {
+    struct gsea_strchunk *next;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+char *gsea_strarena_alloc(gsea_strarena_t *a, size_t n){
+    gsea_strchunk_t *c = a->head;
+    if (!c || c->size - c->used < n){
+        // el chunk a medio llenar se abandona: con chunks de 64 KiB y rutas
+        // de a lo sumo PATH_MAX el desperdicio es chico
+        size_t size = n > STRARENA_CHUNK ? n : STRARENA_CHUNK;
+        c = malloc(sizeof(*c) + size);
+        if (!c) return NULL;
+        c->next = a->head;
+        c->size = size;
+        c->used = 0;
+        a->head = c;
+    }
+    char *p = c->data + c->used;
+    c->used += n;
+    return p;
+}
+
+void gsea_strarena_merge(gsea_strarena_t *dst, gsea_strarena_t *src){
+    if (!src->head) return;
+    // el chunk actual de dst sigue al frente: las próximas cadenas van ahí
+    gsea_strchunk_t *tail = src->head;
+    while (tail->next) tail = tail->next;
+    if (dst->head){
+        tail->next = dst->head->next;
+        dst->head->next = src->head;
+    } else {
+        dst->head = src->head;
+    }
+    src->head = NULL;
+}
+
+void gsea_strarena_free(gsea_strarena_t *a){
+    gsea_strchunk_t *c = a->head;
+    while (c){
+        gsea_strchunk_t *next = c->next;
+        free(c);
+        c = next;
+    }
+    a->head = NULL;
+}
+
+int gsea_buf_reserve(gsea_buf_t *b, size_t n){
+    if (n == 0) n = 1;
+    if (b->cap >= n) return 0;
+    // sin realloc: el contenido no se conserva, no hace falta copiarlo
+    free(b->data);
+    b->data = malloc(n);
+    b->cap = b->data ? n : 0;
+    return b->data ? 0 : -1;
+}
+
+void gsea_buf_free(gsea_buf_t *b){
+    free(b->data);
+    b->data = NULL;
+    b->cap = 0;
+}
@@ -0,0 +1,546 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "container.h"
+#include "uring.h"
+#include "cpus.h"
+#include "pool.h"
+#include "log.h"
+#include "stats.h"
+#include "budget.h"
+
+/*
+ * Lote de directorio sobre io_uring. El hilo llamador hace toda la E/S:
+ * mantiene 'nslots' archivos en vuelo y cada uno avanza por
+ *     abrir entrada -> leer -> (cómputo) -> abrir salida -> escribir -> cerrar
+ * enviando las operaciones de todos los archivos juntas en cada io_uring_enter.
+ * Los workers de cómputo (uno por core) solo aplican la cadena; al terminar
+ * devuelven el slot por la cola 'done' y avisan con un eventfd que el hilo de
+ * E/S también espera a través del anillo.
+ */
+
+// tipo de operación en los bits bajos de user_data
+enum { UD_OPEN_IN, UD_READ, UD_CLOSE_IN, UD_OPEN_OUT, UD_WRITE, UD_CLOSE_OUT, UD_EVENT };
+#define UD(slot, kind)  (((uint64_t)(slot) << 3) | (kind))
+#define UD_SLOT(ud)     ((size_t)((ud) >> 3))
+#define UD_KIND(ud)     ((int)((ud) & 7))
+
+// lectura/escritura máxima por SQE (len es de 32 bits)
+#define BATCH_MAX_IO    (1u << 30)
+
+typedef struct {
+    size_t job;
+    int fd;
+    uint64_t size;                // bytes a leer
+    uint64_t done;                // bytes ya leídos / escritos
+    gsea_opts_t opt;              // opciones con las rutas de este archivo
+    gsea_worker_t w;              // buffers reciclados entre los archivos del slot
+    const uint8_t *out;
+    size_t outn;
+    int rc;
+    int written;                  // el worker ya escribió la salida (contenedor)
+    int self_io;                  // el worker lee y escribe solo (contenedor, stream)
+    gsea_input_t in;              // header de la entrada, leído una vez en start_job
+    int parked;                   // --mem-budget: esperando lugar para el archivo
+    uint64_t need;                // --mem-budget: pico estimado del archivo
+    int64_t start, io_start;      // --stats: inicio del archivo y de la E/S en curso
+} batch_slot_t;
+
+// cola FIFO de índices de slot; nunca tiene más de 'cap' elementos
+typedef struct {
+    size_t *v;
+    size_t cap, head, tail;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+} slot_queue_t;
+
+struct batch {
+    const gsea_opts_t *opt;
+    gsea_file_job_t *jobs;
+    size_t count;
+    size_t next_job;
+    size_t finished;
+    int failed;
+    int64_t t0;                   // --stats: arranque del lote
+    gsea_budget_t *budget;        // --mem-budget, o NULL
+
+    gsea_uring_t ring;
+    batch_slot_t *slots;
+    size_t nslots;
+    slot_queue_t todo;            // leídos, esperando cómputo
+    slot_queue_t done;            // computados, vuelven al hilo de E/S
+
+    int evfd;
+    uint64_t evbuf;
+    int ev_armed;
+};
+
+static int queue_init(slot_queue_t *q, size_t cap){
+    memset(q, 0, sizeof(*q));
+    q->v = calloc(cap, sizeof(*q->v));
+    if (!q->v) return -1;
+    q->cap = cap;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    return 0;
+}
+
+static void queue_destroy(slot_queue_t *q){
+    if (!q->v) return;
+    free(q->v);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+}
+
+static void queue_push(slot_queue_t *q, size_t i){
+    pthread_mutex_lock(&q->lock);
+    q->v[q->tail % q->cap] = i;
+    q->tail++;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// 0 si sacó un índice; -1 si la cola está vacía (sin 'wait') o cerrada
+static int queue_pop(slot_queue_t *q, size_t *i, int wait){
+    pthread_mutex_lock(&q->lock);
+    while (wait && q->head == q->tail && !q->closed){
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    if (q->head == q->tail){
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+    *i = q->v[q->head % q->cap];
+    q->head++;
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+static void queue_close(slot_queue_t *q){
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static int compute_worker(void *ptr){
+    struct batch *b = ptr;
+    size_t i;
+    int64_t alive = gsea_stats_on ? gsea_stats_now() : 0;
+    int64_t busy = 0;
+
+    while (queue_pop(&b->todo, &i, 1) == 0){
+        int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+        batch_slot_t *s = &b->slots[i];
+        if (s->self_io){
+            // contenedor, o archivo que --mem-budget pasó a modo stream: lo
+            // procesa el camino por bloques, que lee y escribe solo
+            s->rc = gsea_process_file_ws(&s->opt, &s->w, &s->in);
+            s->written = 1;
+        } else {
+            s->rc = gsea_apply_ops_ws(&s->opt, &s->w, s->w.in.data, (size_t)s->done,
+                                      &s->out, &s->outn);
+        }
+        if (gsea_stats_on) busy += gsea_stats_now() - t0;
+
+        queue_push(&b->done, i);
+        uint64_t one = 1;
+        ssize_t wr = write(b->evfd, &one, sizeof(one));
+        (void)wr;                 // el contador solo puede desbordar tras 2^64 avisos
+    }
+    if (gsea_stats_on) gsea_stats_worker(gsea_stats_now() - alive, busy);
+    return 0;
+}
+
+static struct io_uring_sqe *get_sqe(struct batch *b){
+    struct io_uring_sqe *sqe = gsea_uring_sqe(&b->ring);
+    if (!sqe){
+        // cola de envío llena: publicar lo pendiente y reintentar
+        if (gsea_uring_submit(&b->ring, 0) != 0) return NULL;
+        sqe = gsea_uring_sqe(&b->ring);
+    }
+    if (!sqe) GSEA_LOG(GSEA_LOG_ERROR, "uring", "cola de envío llena");
+    return sqe;
+}
+
+static int prep_open(struct batch *b, size_t i, int kind, const char *path,
+                     int flags){
+    struct io_uring_sqe *sqe = get_sqe(b);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t)(uintptr_t)path;
+    sqe->open_flags = (uint32_t)(flags | O_CLOEXEC);
+    sqe->len = 0644;
+    sqe->user_data = UD(i, kind);
+    return 0;
+}
+
+static int prep_rw(struct batch *b, size_t i, int kind, int opcode, int fd,
+                   const void *buf, uint64_t len, uint64_t off){
+    struct io_uring_sqe *sqe = get_sqe(b);
+    if (!sqe) return -1;
+    sqe->opcode = (uint8_t)opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (uint32_t)(len < BATCH_MAX_IO ? len : BATCH_MAX_IO);
+    sqe->off = off;
+    sqe->user_data = UD(i, kind);
+    return 0;
+}
+
+static int prep_close(struct batch *b, size_t i, int kind, int fd){
+    struct io_uring_sqe *sqe = get_sqe(b);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = UD(i, kind);
+    return 0;
+}
+
+static int arm_event(struct batch *b){
+    if (prep_rw(b, 0, UD_EVENT, IORING_OP_READ, b->evfd,
+                &b->evbuf, sizeof(b->evbuf), 0) != 0) return -1;
+    b->ev_armed = 1;
+    return 0;
+}
+
+static void start_job(struct batch *b, size_t i);
+static void launch_job(struct batch *b, size_t i);
+
+static void finish_job(struct batch *b, size_t i, int rc){
+    batch_slot_t *s = &b->slots[i];
+    gsea_file_job_t *j = &b->jobs[s->job];
+    if (rc != 0){
+        GSEA_LOG(GSEA_LOG_ERROR, "uring", "fallo %s -> %s rc=%d", j->in_path, j->out_path, rc);
+        b->failed = 1;
+    } else {
+        GSEA_LOG(GSEA_LOG_DEBUG, "uring", "OK %s -> %s", j->in_path, j->out_path);
+        j->ok = 1;
+    }
+    if (gsea_stats_on){
+        // un contenedor decodificado lo escribió el camino por bloques
+        struct stat st;
+        uint64_t out = rc != 0 ? 0 : !s->written ? s->outn :
+                       stat(j->out_path, &st) == 0 ? (uint64_t)st.st_size : 0;
+        gsea_stats_file(j->in_path, j->size, out, s->start, gsea_stats_now(),
+                        s->start - b->t0, rc == 0);
+    }
+    b->finished++;
+    if (b->budget){
+        // lo liberado puede alcanzar para los archivos que esperan lugar
+        gsea_budget_end(b->budget, &s->w);
+        for (size_t k = 0; k < b->nslots; k++){
+            batch_slot_t *p = &b->slots[k];
+            if (p->parked && gsea_budget_try_begin(b->budget, &p->w, p->need, 1)){
+                p->parked = 0;
+                launch_job(b, k);
+            }
+        }
+    }
+    start_job(b, i);
+}
+
+static void io_error(const char *what, const char *path, int32_t res){
+    GSEA_LOG(GSEA_LOG_ERROR, "uring", "%s %s: %s", what, path, strerror(-res));
+}
+
+static void start_job(struct batch *b, size_t i){
+    if (b->next_job >= b->count) return;
+    batch_slot_t *s = &b->slots[i];
+    s->job = b->next_job++;
+    s->fd = -1;
+    s->size = b->jobs[s->job].size;
+    s->done = 0;
+    s->opt = *b->opt;
+    s->opt.in_path = b->jobs[s->job].in_path;
+    s->opt.out_path = b->jobs[s->job].out_path;
+    s->out = NULL;
+    s->outn = 0;
+    s->rc = 0;
+    s->written = 0;
+    s->start = gsea_stats_on ? gsea_stats_now() : 0;
+    // -d/-u sobre un contenedor (o un archivo sólido): se mira solo la
+    // cabecera, el camino por bloques lee lo que necesita sin la carga entera
+    memset(&s->in, 0, sizeof(s->in));
+    gsea_input_probe(&s->opt, &s->in);
+    s->self_io = s->in.framed != 0;
+    if (b->budget){
+        // el hilo de E/S no espera: el slot queda estacionado hasta que
+        // termine otro archivo y libere lugar. El camino por bloques se
+        // acota con su ventana
+        s->need = s->self_io ? 0 : gsea_budget_fit(b->budget, &s->opt, s->size);
+        if (s->opt.stream) s->self_io = 1;
+        if (!gsea_budget_try_begin(b->budget, &s->w, s->need, 0)){
+            s->parked = 1;
+            return;
+        }
+    }
+    launch_job(b, i);
+}
+
+static void launch_job(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (s->self_io){
+        queue_push(&b->todo, i);
+        return;
+    }
+    if (prep_open(b, i, UD_OPEN_IN, s->opt.in_path, O_RDONLY) != 0){
+        finish_job(b, i, -1);
+    }
+}
+
+// entrada completa en s->w.in: cerrar sin esperar y pasar a cómputo
+static void read_done(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (prep_close(b, i, UD_CLOSE_IN, s->fd) != 0) close(s->fd);
+    s->fd = -1;
+    queue_push(&b->todo, i);
+}
+
+static void submit_read(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (gsea_stats_on) s->io_start = gsea_stats_now();
+    if (prep_rw(b, i, UD_READ, IORING_OP_READ, s->fd, s->w.in.data + s->done,
+                s->size - s->done, s->done) != 0){
+        close(s->fd);
+        finish_job(b, i, -1);
+    }
+}
+
+static void submit_write(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (gsea_stats_on) s->io_start = gsea_stats_now();
+    if (prep_rw(b, i, UD_WRITE, IORING_OP_WRITE, s->fd, s->out + s->done,
+                s->outn - s->done, s->done) != 0){
+        close(s->fd);
+        finish_job(b, i, -1);
+    }
+}
+
+static void submit_close_out(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (prep_close(b, i, UD_CLOSE_OUT, s->fd) != 0){
+        close(s->fd);
+        finish_job(b, i, -1);
+    }
+}
+
+// un slot volvió del cómputo
+static void compute_done(struct batch *b, size_t i){
+    batch_slot_t *s = &b->slots[i];
+    if (s->rc != 0 || s->written){
+        finish_job(b, i, s->rc);
+        return;
+    }
+    if (prep_open(b, i, UD_OPEN_OUT, s->opt.out_path,
+                  O_WRONLY | O_CREAT | O_TRUNC) != 0){
+        finish_job(b, i, -1);
+    }
+}
+
+static void handle_cqe(struct batch *b, uint64_t ud, int32_t res){
+    size_t i = UD_SLOT(ud);
+    batch_slot_t *s = &b->slots[i];
+
+    switch (UD_KIND(ud)){
+    case UD_EVENT: {
+        b->ev_armed = 0;
+        size_t k;
+        while (queue_pop(&b->done, &k, 0) == 0) compute_done(b, k);
+        if (b->finished < b->count && arm_event(b) != 0) b->failed = -1;
+        break;
+    }
+    case UD_OPEN_IN:
+        if (res < 0){
+            io_error("open", s->opt.in_path, res);
+            finish_job(b, i, -1);
+            break;
+        }
+        s->fd = res;
+        if (gsea_worker_reserve(&s->w, &s->w.in, (size_t)s->size + GSEA_CODEC_MAX_PAD) != 0){
+            perror("malloc");
+            close(s->fd);
+            finish_job(b, i, -1);
+            break;
+        }
+        if (s->size == 0) read_done(b, i);
+        else submit_read(b, i);
+        break;
+    case UD_READ:
+        if (res < 0){
+            io_error("read", s->opt.in_path, res);
+            close(s->fd);
+            finish_job(b, i, -1);
+            break;
+        }
+        s->done += (uint64_t)res;
+        // con --stats el tiempo es la latencia del pedido, solapada con los demás
+        if (gsea_stats_on){
+            gsea_stats_stage("io_uring", "read", (uint64_t)res, (uint64_t)res,
+                             gsea_stats_now() - s->io_start);
+        }
+        // res == 0: el archivo se achicó desde que se listó el directorio
+        if (res == 0 || s->done == s->size) read_done(b, i);
+        else submit_read(b, i);
+        break;
+    case UD_CLOSE_IN:
+        break;
+    case UD_OPEN_OUT:
+        if (res < 0){
+            io_error("open", s->opt.out_path, res);
+            finish_job(b, i, -1);
+            break;
+        }
+        s->fd = res;
+        s->done = 0;
+        if (s->outn == 0) submit_close_out(b, i);
+        else submit_write(b, i);
+        break;
+    case UD_WRITE:
+        if (res <= 0){
+            io_error("write", s->opt.out_path, res < 0 ? res : -EIO);
+            s->rc = -1;
+            submit_close_out(b, i);
+            break;
+        }
+        s->done += (uint64_t)res;
+        if (gsea_stats_on){
+            gsea_stats_stage("io_uring", "write", (uint64_t)res, (uint64_t)res,
+                             gsea_stats_now() - s->io_start);
+        }
+        if (s->done < s->outn) submit_write(b, i);
+        else submit_close_out(b, i);
+        break;
+    case UD_CLOSE_OUT:
+        if (res < 0){
+            io_error("close", s->opt.out_path, res);
+            s->rc = -1;
+        }
+        finish_job(b, i, s->rc);
+        break;
+    }
+}
+
+// espera completados y los procesa; -1 si falla io_uring_enter
+static int reap(struct batch *b){
+    if (gsea_uring_submit(&b->ring, 1) != 0){
+        perror("io_uring_enter");
+        return -1;
+    }
+    uint64_t ud;
+    int32_t res;
+    while (gsea_uring_cqe(&b->ring, &ud, &res)) handle_cqe(b, ud, res);
+    return 0;
+}
+
+int gsea_dir_uring(const gsea_opts_t *opt, gsea_file_job_t *jobs, size_t count){
+    struct batch b;
+    memset(&b, 0, sizeof(b));
+    b.opt = opt;
+    b.jobs = jobs;
+    b.count = count;
+    b.evfd = -1;
+    b.t0 = gsea_stats_on ? gsea_stats_now() : 0;
+
+    size_t nworkers = (size_t)gsea_jobs(opt);
+    if (nworkers > count) nworkers = count;
+    // archivos en vuelo: los suficientes para que siempre haya E/S pendiente
+    b.nslots = nworkers * 4;
+    if (b.nslots < 8) b.nslots = 8;
+    if (b.nslots > count) b.nslots = count;
+
+    // --mem-budget: cada slot retiene buffers entre archivos
+    gsea_budget_t budget;
+    if (opt->mem_budget){
+        if (gsea_budget_init(&budget, opt, b.nslots) != 0) return -1;
+        b.budget = &budget;
+    }
+
+    // por slot: una operación propia + el cierre de la entrada; más el eventfd
+    if (gsea_uring_init(&b.ring, (unsigned)(2 * b.nslots + 1)) != 0){
+        if (b.budget) gsea_budget_destroy(b.budget);
+        return -2;
+    }
+    b.evfd = eventfd(0, EFD_CLOEXEC);
+    if (b.evfd < 0){
+        int e = errno;
+        gsea_uring_exit(&b.ring);
+        if (b.budget) gsea_budget_destroy(b.budget);
+        errno = e;
+        return -2;
+    }
+
+    b.slots = calloc(b.nslots, sizeof(*b.slots));
+    gsea_pool_t *pool = gsea_pool_shared();
+    if (!b.slots || !pool ||
+        queue_init(&b.todo, b.nslots) != 0 || queue_init(&b.done, b.nslots) != 0){
+        perror("calloc lote");
+        queue_destroy(&b.todo);
+        queue_destroy(&b.done);
+        free(b.slots);
+        close(b.evfd);
+        gsea_uring_exit(&b.ring);
+        if (b.budget) gsea_budget_destroy(b.budget);
+        return -1;
+    }
+
+    // los workers esperan trabajo en la cola: cada uno necesita su hilo
+    gsea_group_t g;
+    gsea_group_init(&g);
+    size_t started = 0;
+    for (size_t i = 0; i < nworkers; i++){
+        if (gsea_pool_spawn(pool, &g, compute_worker, &b) != 0) break;
+        started++;
+    }
+
+    GSEA_LOG(GSEA_LOG_INFO, "pool", "archivos=%zu, cpus=%d, workers=%zu, en vuelo=%zu (io_uring)",
+             count, gsea_cpu_count(), started, b.nslots);
+
+    int fatal = started == 0 || arm_event(&b) != 0;
+    if (!fatal){
+        for (size_t i = 0; i < b.nslots; i++) start_job(&b, i);
+        while (b.finished < b.count){
+            if (b.failed < 0 || reap(&b) != 0){
+                fatal = 1;
+                break;
+            }
+        }
+    }
+
+    // recoger la lectura pendiente del eventfd antes de liberar su buffer
+    if (!fatal && b.ev_armed){
+        uint64_t one = 1;
+        ssize_t wr = write(b.evfd, &one, sizeof(one));
+        (void)wr;
+        while (b.ev_armed && reap(&b) == 0) {}
+    }
+
+    queue_close(&b.todo);
+    gsea_pool_wait(pool, &g);
+    gsea_group_destroy(&g);
+
+    // tras un error del anillo el kernel puede seguir usando los buffers:
+    // se cierra el anillo antes de liberarlos
+    gsea_uring_exit(&b.ring);
+    close(b.evfd);
+    for (size_t i = 0; i < b.nslots; i++) gsea_worker_free(&b.slots[i].w);
+    queue_destroy(&b.todo);
+    queue_destroy(&b.done);
+    free(b.slots);
+    if (b.budget){
+        gsea_budget_report(b.budget);
+        gsea_budget_destroy(b.budget);
+    }
+    return fatal || b.failed ? -1 : 0;
+}
@@ -0,0 +1,352 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "stream.h"
+#include "crc32c.h"
+#include "cpus.h"
+#include "pool.h"
+
+// resultado de un bloque esperando a ser escrito en orden
+typedef struct {
+    uint8_t *data;
+    size_t   len;
+    gsea_blkinfo_t info;
+    int      ready;
+} blk_slot_t;
+
+struct gsea_blkjob {
+    gsea_opts_t opt;              // copia: el pool reutiliza la suya entre archivos
+    gsea_stream_t st;
+    int closed;
+    int fd_in;
+    int framed_in;
+    size_t chunk;
+    uint64_t insize;
+    gsea_index_t in_idx;          // bloques de entrada si viene por frames
+    gsea_vsource_t vs;            // entrada virtual (read != NULL)
+    size_t nblocks;
+
+    // ventana de bloques en vuelo: como mucho 'window' por delante del
+    // escritor, así la memoria queda acotada sin importar el tamaño total
+    blk_slot_t *slots;
+    size_t window;
+    size_t next;                  // próximo bloque a tomar
+    size_t written;               // próximo bloque a escribir
+    size_t inflight;              // tomados y todavía en proceso
+    int writing;                  // algún hilo está escribiendo en orden
+    int failed;
+    int finished;                 // el final ya se informó a un llamador
+    pthread_mutex_t lock;
+    pthread_cond_t  space;        // los que esperan lugar en la ventana
+};
+
+// carga el bloque i de la entrada (info queda con el tamaño y CRC del original)
+static int load_block(gsea_blkjob_t *c, size_t i, uint8_t **buf, size_t *len,
+                      gsea_blkinfo_t *info){
+    if (c->framed_in){
+        const gsea_block_t *b = &c->in_idx.v[i];
+        *len = b->stored_len;
+        return gsea_frame_load(c->fd_in, &c->st.src.hdr, b, buf, info);
+    }
+    uint64_t off = (uint64_t)i * c->chunk;
+    *len = c->insize - off < c->chunk ? (size_t)(c->insize - off) : c->chunk;
+    if (c->vs.starts){
+        off = c->vs.starts[i];
+        *len = (size_t)(c->vs.starts[i + 1] - off);
+    }
+    *buf = malloc(*len ? *len : 1);
+    if (!*buf){
+        perror("malloc bloque");
+        return -1;
+    }
+    if (c->vs.read){
+        if (c->vs.read(c->vs.ctx, *buf, *len, off) != 0){
+            free(*buf);
+            return -1;
+        }
+    } else if (gsea_pread_full(c->fd_in, *buf, *len, off) != 0){
+        perror("pread");
+        free(*buf);
+        return -1;
+    }
+    info->raw_len = (uint32_t)*len;
+    info->raw_crc = gsea_crc32c(*buf, *len);
+    return 0;
+}
+
+static gsea_blkjob_t *blkjob_new(const gsea_opts_t *opt, const gsea_header_t *in_hdr){
+    gsea_blkjob_t *c = calloc(1, sizeof(*c));
+    if (!c){
+        perror("calloc bloques");
+        return NULL;
+    }
+    c->opt = *opt;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->space, NULL);
+    if (gsea_stream_open(&c->opt, in_hdr, &c->st) != 0){
+        c->closed = 1;
+        gsea_blkjob_free(c);
+        return NULL;
+    }
+    c->fd_in = c->st.src.fd;
+    c->framed_in = c->st.plan.framed_in;
+    c->chunk = c->st.src.chunk;
+    return c;
+}
+
+// cuenta los bloques de la entrada; 1 si no es un archivo regular
+static int blkjob_prepare(gsea_blkjob_t *c){
+    struct stat st;
+    if (fstat(c->fd_in, &st) != 0 || !S_ISREG(st.st_mode)) return 1;
+    if (c->framed_in){
+        uint64_t start = gsea_header_size(&c->st.plan.in_hdr);
+        if (gsea_index_read(c->fd_in, start, gsea_frame_hdr_size(c->st.src.hdr.version),
+                            &c->in_idx) != 0){
+            return -1;
+        }
+        c->nblocks = c->in_idx.n;
+    } else {
+        c->insize = (uint64_t)st.st_size;
+        c->nblocks = (size_t)((c->insize + c->chunk - 1) / c->chunk);
+    }
+    return 0;
+}
+
+static int blkjob_window(gsea_blkjob_t *c, size_t window){
+    c->window = window ? window : 1;
+    c->slots = calloc(c->window, sizeof(*c->slots));
+    if (!c->slots){
+        perror("calloc bloques");
+        return -1;
+    }
+    return 0;
+}
+
+gsea_blkjob_t *gsea_blkjob_open(const gsea_opts_t *opt, const gsea_header_t *in_hdr,
+                                size_t window){
+    gsea_blkjob_t *c = blkjob_new(opt, in_hdr);
+    if (!c) return NULL;
+    int pr = blkjob_prepare(c);
+    if (pr > 0) fprintf(stderr, "bloques: '%s' no es un archivo regular\n", opt->in_path);
+    if (pr != 0 || blkjob_window(c, window) != 0){
+        c->failed = 1;
+        gsea_blkjob_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+gsea_blkjob_t *gsea_blkjob_open_virtual(const gsea_opts_t *opt, size_t window,
+                                        const gsea_vsource_t *vs, uint8_t hdr_flags){
+    gsea_blkjob_t *c = calloc(1, sizeof(*c));
+    if (!c){
+        perror("calloc bloques");
+        return NULL;
+    }
+    c->opt = *opt;
+    c->vs = *vs;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->space, NULL);
+    c->closed = 1;                // hasta abrir la salida no hay nada que cerrar
+
+    gsea_stream_t *st = &c->st;
+    c->chunk = opt->chunk_size ? opt->chunk_size : GSEA_DEFAULT_CHUNK;
+    c->insize = vs->size;
+    c->nblocks = vs->starts ? vs->nblocks : (size_t)((c->insize + c->chunk - 1) / c->chunk);
+    c->fd_in = -1;
+    // la salida es siempre un contenedor, aunque la cadena esté vacía
+    if (gsea_plan_build(&c->opt, 0, NULL, c->chunk, &st->plan) != 0 ||
+        blkjob_window(c, window) != 0){
+        gsea_blkjob_free(c);
+        return NULL;
+    }
+    st->plan.framed_out = 1;
+    st->plan.out_hdr.flags |= hdr_flags;
+
+    st->in_path = opt->in_path;
+    st->src.fd = -1;
+    st->src.chunk = c->chunk;
+    st->sink.fd = gsea_open_out(opt->out_path);
+    if (st->sink.fd < 0){
+        perror("open out");
+        gsea_blkjob_free(c);
+        return NULL;
+    }
+    c->closed = 0;
+    st->sink.framed = 1;
+    st->sink.idx.frame_hdr = GSEA_FRAME_HDR;
+    if (gsea_header_write(st->sink.fd, &st->plan.out_hdr) != 0){
+        perror("write header");
+        c->failed = 1;
+        gsea_blkjob_free(c);
+        return NULL;
+    }
+    st->sink.idx.pos = gsea_header_size(&st->plan.out_hdr);
+    return c;
+}
+
+size_t gsea_blkjob_blocks(const gsea_blkjob_t *c){
+    return c->nblocks;
+}
+
+int gsea_blkjob_take(gsea_blkjob_t *c, int wait, size_t *i){
+    pthread_mutex_lock(&c->lock);
+    while (wait && !c->failed && c->next < c->nblocks &&
+           c->next - c->written >= c->window){
+        pthread_cond_wait(&c->space, &c->lock);
+    }
+    int got;
+    if (c->failed || c->next >= c->nblocks){
+        got = -1;
+    } else if (c->next - c->written >= c->window){
+        got = 0;
+    } else {
+        *i = c->next++;
+        c->inflight++;
+        got = 1;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return got;
+}
+
+// Con el lock tomado: si el próximo bloque a escribir está listo y nadie está
+// escribiendo, este hilo escribe en orden todo lo que haya listo. Se suelta
+// el lock durante cada write, así los demás siguen guardando resultados.
+static void write_ready(gsea_blkjob_t *c){
+    if (c->writing) return;
+    c->writing = 1;
+    while (!c->failed && c->written < c->nblocks){
+        blk_slot_t *s = &c->slots[c->written % c->window];
+        if (!s->ready) break;
+        blk_slot_t got = *s;
+        memset(s, 0, sizeof(*s));
+        c->written++;
+        pthread_cond_broadcast(&c->space);
+        pthread_mutex_unlock(&c->lock);
+
+        int wr = gsea_sink_put(&c->st.sink, got.data, got.len, &got.info);
+        free(got.data);
+
+        pthread_mutex_lock(&c->lock);
+        if (wr != 0) c->failed = 1;
+    }
+    c->writing = 0;
+}
+
+int gsea_blkjob_run(gsea_blkjob_t *c, size_t i){
+    uint8_t *in = NULL, *res = NULL;
+    size_t inlen = 0, reslen = 0;
+    gsea_blkinfo_t info = { 0, 0 };
+    int rc = load_block(c, i, &in, &inlen, &info);
+    if (rc == 0){
+        rc = gsea_plan_apply(&c->st.plan, &c->opt, info.raw_len, 0, c->st.plan.nsteps,
+                             in, inlen, &res, &reslen);
+        free(in);
+    }
+    if (rc == 0 && gsea_sink_check(&c->st.sink, res, reslen, &info) != 0){
+        free(res);
+        rc = -1;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    if (rc != 0){
+        c->failed = 1;
+    } else {
+        blk_slot_t *s = &c->slots[i % c->window];
+        s->data = res;
+        s->len = reslen;
+        s->info = info;
+        s->ready = 1;
+        write_ready(c);
+    }
+    // tras un error nadie más toma bloques: despertar a los que esperan lugar
+    if (c->failed) pthread_cond_broadcast(&c->space);
+    c->inflight--;
+    int end = !c->finished && c->inflight == 0 &&
+              (c->failed || c->written == c->nblocks);
+    if (end) c->finished = 1;
+    pthread_mutex_unlock(&c->lock);
+    return end;
+}
+
+int gsea_blkjob_finish(gsea_blkjob_t *c){
+    int rc = c->failed || c->written != c->nblocks ? -1 : 0;
+    if (!c->closed){
+        c->closed = 1;
+        rc = gsea_stream_close(&c->st, rc);
+    }
+    return rc;
+}
+
+void gsea_blkjob_free(gsea_blkjob_t *c){
+    if (!c) return;
+    if (!c->closed){
+        c->closed = 1;
+        gsea_stream_close(&c->st, -1);
+    }
+    // resultados que quedaron sin escribir tras un error
+    for (size_t i = 0; c->slots && i < c->window; i++) free(c->slots[i].data);
+    free(c->slots);
+    gsea_index_free(&c->in_idx);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->space);
+    free(c);
+}
+
+static int block_worker(void *ptr){
+    gsea_blkjob_t *c = ptr;
+    size_t i;
+    while (gsea_blkjob_take(c, 1, &i) == 1) gsea_blkjob_run(c, i);
+    return 0;
+}
+
+int gsea_blkjob_process(gsea_blkjob_t *c, size_t nthreads){
+    // El hilo llamador es uno de los workers; el que completa el prefijo
+    // pendiente escribe, sin hilo escritor aparte. Las tareas van al pool
+    // compartido: si está ocupado (modo directorio) el llamador hace todos
+    // los bloques y las tareas que arrancan tarde no encuentran nada
+    gsea_pool_t *pool = gsea_pool_shared();
+    gsea_group_t g;
+    gsea_group_init(&g);
+    for (size_t i = 1; pool && i < nthreads; i++){
+        if (gsea_pool_submit(pool, &g, block_worker, c) != 0) break;
+    }
+    block_worker(c);
+    if (pool) gsea_pool_wait(pool, &g);
+    gsea_group_destroy(&g);
+    return gsea_blkjob_finish(c);
+}
+
+int gsea_process_blocks(const gsea_opts_t *opt, const gsea_header_t *in_hdr){
+    gsea_blkjob_t *c = blkjob_new(opt, in_hdr);
+    if (!c) return -1;
+    int pr = blkjob_prepare(c);
+    if (pr > 0){
+        // pipe: sin tamaño ni tabla de bloques no se puede repartir, modo secuencial
+        c->closed = 1;
+        int rc = gsea_stream_run(&c->opt, &c->st);
+        gsea_blkjob_free(c);
+        return rc;
+    }
+
+    size_t nthreads = (size_t)gsea_jobs(opt);
+    if (nthreads > c->nblocks) nthreads = c->nblocks;
+    if (pr != 0 || blkjob_window(c, nthreads * 2) != 0){
+        c->failed = 1;
+        int rc = gsea_blkjob_finish(c);
+        gsea_blkjob_free(c);
+        return rc;
+    }
+
+    int rc = gsea_blkjob_process(c, nthreads);
+    gsea_blkjob_free(c);
+    return rc;
+}
@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include "budget.h"
+#include "log.h"
+
+// lo que puede retener cada worker entre archivos: hasta 16 MiB y como
+// mucho un cuarto del presupuesto entre todos
+#define KEEP_MAX     (16u << 20)
+// expansión supuesta de una descompresión (la real se carga al reservar)
+#define INFLATE      4
+
+static uint64_t mib(uint64_t n){
+    return (n + (1u << 19)) >> 20;
+}
+
+int gsea_budget_init(gsea_budget_t *b, const gsea_opts_t *opt, size_t workers){
+    memset(b, 0, sizeof(*b));
+    b->nsteps = gsea_steps_from_opts(opt, b->steps);
+    if (b->nsteps < 0) return -1;
+    if (workers == 0) workers = 1;
+    b->workers = workers;
+    b->total = opt->mem_budget;
+    b->keep = b->total / 4 / workers;
+    if (b->keep > KEEP_MAX) b->keep = KEEP_MAX;
+    b->limit = b->total - b->keep * workers;
+    b->chunk = opt->chunk_size ? opt->chunk_size : GSEA_DEFAULT_CHUNK;
+
+    // modo stream de respaldo: solo si toda la cadena va hacia adelante y
+    // cada codec trabaja por bloques independientes
+    b->can_stream = b->nsteps > 0;
+    for (int i = 0; i < b->nsteps; i++){
+        const gsea_codec_t *c = gsea_codec_by_id(b->steps[i].alg);
+        if (!c || gsea_step_inverse(b->steps[i].op) || !(c->flags & GSEA_CODEC_STREAMING)){
+            b->can_stream = 0;
+        }
+    }
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    return 0;
+}
+
+void gsea_budget_report(const gsea_budget_t *b){
+    GSEA_LOG(GSEA_LOG_INFO, "budget",
+             "presupuesto=%llu MiB, pico=%llu MiB (+%llu MiB retenidos), esperas=%zu, a stream=%zu",
+             (unsigned long long)mib(b->total), (unsigned long long)mib(b->peak),
+             (unsigned long long)mib(b->keep * b->workers), b->waits, b->streamed);
+}
+
+void gsea_budget_destroy(gsea_budget_t *b){
+    pthread_cond_destroy(&b->cond);
+    pthread_mutex_destroy(&b->lock);
+}
+
+uint64_t gsea_budget_estimate(const gsea_budget_t *b, uint64_t size){
+    // la misma elección de buffer que gsea_apply_steps_ws: los cifrados en
+    // el lugar si caben, el resto alterna entre stage[0] y stage[1]
+    uint64_t in = size + GSEA_CODEC_MAX_PAD;
+    uint64_t stage[2] = { 0, 0 };
+    int own = -1;                 // -1: la entrada
+    uint64_t cur = size;
+    for (int i = 0; i < b->nsteps; i++){
+        const gsea_codec_t *c = gsea_codec_by_id(b->steps[i].alg);
+        if (!c) break;
+        char op = b->steps[i].op;
+        uint64_t bound;
+        if (op == 'd'){
+            bound = cur * INFLATE;
+        } else if (op == 'u'){
+            bound = cur;
+        } else {
+            // sin datos forward_bound da el peor caso
+            size_t fb = 0;
+            if (c->forward_bound(NULL, (size_t)cur, &fb) != 0) fb = (size_t)cur * 2;
+            bound = fb;
+        }
+        uint64_t cap = own < 0 ? in : stage[own];
+        if (!((c->flags & GSEA_CODEC_INPLACE) && cap >= bound)){
+            own = own == 0 ? 1 : 0;
+            if (stage[own] < bound) stage[own] = bound;
+        }
+        cur = bound;
+    }
+    return in + stage[0] + stage[1];
+}
+
+uint64_t gsea_budget_fit(gsea_budget_t *b, gsea_opts_t *opt, uint64_t size){
+    uint64_t need = gsea_budget_estimate(b, size);
+    if (need <= b->limit) return need;
+    if (b->can_stream){
+        opt->stream = 1;
+        pthread_mutex_lock(&b->lock);
+        b->streamed++;
+        pthread_mutex_unlock(&b->lock);
+        GSEA_LOG(GSEA_LOG_DEBUG, "budget", "%s: %llu MiB no entran, modo stream",
+                 opt->in_path, (unsigned long long)mib(need));
+        // bloque leído, sus etapas y el marco que se escribe
+        return gsea_budget_estimate(b, b->chunk) + b->chunk;
+    }
+    GSEA_LOG(GSEA_LOG_WARN, "budget", "%s: %llu MiB superan el presupuesto; se procesa solo",
+             opt->in_path, (unsigned long long)mib(need));
+    return need;
+}
+
+static void admit(gsea_budget_t *b, gsea_worker_t *w, uint64_t need){
+    b->used += need;
+    b->running++;
+    if (b->used > b->peak) b->peak = b->used;
+    w->admitted = need;
+}
+
+static int fits(const gsea_budget_t *b, uint64_t need){
+    return b->running == 0 || b->used + need <= b->limit;
+}
+
+void gsea_budget_begin(gsea_budget_t *b, gsea_worker_t *w, uint64_t need){
+    w->budget = b;
+    w->admitted = 0;
+    if (need > b->keep){
+        pthread_mutex_lock(&b->lock);
+        if (!fits(b, need)){
+            b->waits++;
+            while (!fits(b, need)) pthread_cond_wait(&b->cond, &b->lock);
+        }
+        admit(b, w, need);
+        pthread_mutex_unlock(&b->lock);
+    }
+    w->charged = b->keep + w->admitted;
+}
+
+int gsea_budget_try_begin(gsea_budget_t *b, gsea_worker_t *w, uint64_t need, int retry){
+    if (need > b->keep){
+        pthread_mutex_lock(&b->lock);
+        int ok = fits(b, need);
+        if (ok) admit(b, w, need);
+        else if (!retry) b->waits++;
+        pthread_mutex_unlock(&b->lock);
+        if (!ok) return 0;
+    } else {
+        w->admitted = 0;
+    }
+    w->budget = b;
+    w->charged = b->keep + w->admitted;
+    return 1;
+}
+
+void gsea_budget_end(gsea_budget_t *b, gsea_worker_t *w){
+    uint64_t held = (uint64_t)w->in.cap + w->stage[0].cap + w->stage[1].cap;
+    uint64_t extra = w->charged - b->keep;
+    if (held > b->keep) gsea_worker_free(w);
+    if (extra > 0 || w->admitted){
+        pthread_mutex_lock(&b->lock);
+        b->used -= extra;
+        if (w->admitted) b->running--;
+        pthread_cond_broadcast(&b->cond);
+        pthread_mutex_unlock(&b->lock);
+    }
+    w->budget = NULL;
+    w->charged = w->admitted = 0;
+}
+
+void gsea_budget_charge(gsea_budget_t *b, uint64_t n){
+    pthread_mutex_lock(&b->lock);
+    b->used += n;
+    if (b->used > b->peak) b->peak = b->used;
+    pthread_mutex_unlock(&b->lock);
+}
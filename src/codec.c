@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include "codec.h"
+#include "rle.h"
+#include "lzw.h"
+#include "huffman.h"
+#include "vigenere.h"
+#include "des.h"
+#include "aes.h"
+
+// adaptadores a la firma común (los compresores ignoran la clave)
+
+static int rle_fwd_bound(const uint8_t *in, size_t n, size_t *size){
+    // contar las corridas es más barato que comprimir y da el tamaño exacto;
+    // sin datos, el peor caso: una corrida por byte
+    *size = in ? rle_compressed_size(in, n) : rle_compressed_bound(n);
+    return 0;
+}
+
+static int rle_inv_bound(const uint8_t *in, size_t n, size_t *size){
+    *size = rle_decompressed_size(in, n);
+    return 0;
+}
+
+static int rle_fwd(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return rle_compress_into(in, n, out, outn);
+}
+
+static int rle_inv(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return rle_decompress_into(in, n, out, outn);
+}
+
+static int lzw_fwd_bound(const uint8_t *in, size_t n, size_t *size){
+    (void)in;
+    *size = lzw_compressed_bound(n);
+    return 0;
+}
+
+static int lzw_fwd(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return lzw_compress_into(in, n, out, outn);
+}
+
+static int lzw_inv(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return lzw_decompress_into(in, n, out, outn);
+}
+
+static int huffman_fwd_bound(const uint8_t *in, size_t n, size_t *size){
+    (void)in;
+    *size = huffman_compressed_bound(n);
+    return 0;
+}
+
+static int huffman_fwd(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                       uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return huffman_compress_into(in, n, out, outn);
+}
+
+static int huffman_inv(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                       uint8_t *out, size_t *outn){
+    (void)key; (void)klen;
+    return huffman_decompress_into(in, n, out, outn);
+}
+
+static int same_bound(const uint8_t *in, size_t n, size_t *size){
+    (void)in;
+    *size = n;
+    return 0;
+}
+
+static int vig_fwd(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    *outn = n;
+    return vig_encrypt_into(in, n, key, klen, out);
+}
+
+static int vig_inv(const uint8_t *in, size_t n, const uint8_t *key, size_t klen,
+                   uint8_t *out, size_t *outn){
+    *outn = n;
+    return vig_decrypt_into(in, n, key, klen, out);
+}
+
+static int des_fwd_bound(const uint8_t *in, size_t n, size_t *size){
+    (void)in;
+    *size = des_encrypted_size(n);
+    return 0;
+}
+
+static int aes_fwd_bound(const uint8_t *in, size_t n, size_t *size){
+    (void)in;
+    *size = aes_encrypted_size(n);
+    return 0;
+}
+
+static const gsea_codec_t codecs[] = {
+    { "rle", GSEA_ALG_RLE, 'c', GSEA_CODEC_STREAMING, 1,
+      rle_fwd_bound, rle_inv_bound, rle_fwd, rle_inv },
+    { "lzw", GSEA_ALG_LZW, 'c', GSEA_CODEC_STREAMING, 1,
+      lzw_fwd_bound, lzw_decompressed_size, lzw_fwd, lzw_inv },
+    { "huffman", GSEA_ALG_HUFFMAN, 'c', GSEA_CODEC_STREAMING, 1,
+      huffman_fwd_bound, huffman_decompressed_size, huffman_fwd, huffman_inv },
+    { "vigenere", GSEA_ALG_VIGENERE, 'e',
+      GSEA_CODEC_INPLACE | GSEA_CODEC_SAMESIZE | GSEA_CODEC_STREAMING | GSEA_CODEC_NEEDS_KEY, 1,
+      same_bound, same_bound, vig_fwd, vig_inv },
+    { "des", GSEA_ALG_DES, 'e',
+      GSEA_CODEC_INPLACE | GSEA_CODEC_PADDED | GSEA_CODEC_STREAMING | GSEA_CODEC_NEEDS_KEY, 8,
+      des_fwd_bound, same_bound, des_encrypt_into, des_decrypt_into },
+    { "aes", GSEA_ALG_AES, 'e',
+      GSEA_CODEC_INPLACE | GSEA_CODEC_PADDED | GSEA_CODEC_STREAMING | GSEA_CODEC_NEEDS_KEY, 16,
+      aes_fwd_bound, same_bound, aes_encrypt_into, aes_decrypt_into },
+};
+
+#define N_CODECS (sizeof(codecs) / sizeof(codecs[0]))
+
+const gsea_codec_t *gsea_codec_by_id(uint8_t id){
+    for (size_t i = 0; i < N_CODECS; i++){
+        if (codecs[i].id == id) return &codecs[i];
+    }
+    return NULL;
+}
+
+const gsea_codec_t *gsea_codec_find(char kind, const char *name){
+    for (size_t i = 0; i < N_CODECS; i++){
+        if (codecs[i].kind == kind && strcmp(codecs[i].name, name) == 0){
+            return &codecs[i];
+        }
+    }
+    return NULL;
+}
+
+const gsea_codec_t *gsea_codec_for_op(const gsea_opts_t *opt, char op){
+    if (op == 'c' || op == 'd'){
+        const char *alg = opt->comp_alg ? opt->comp_alg : "rle";
+        const gsea_codec_t *c = gsea_codec_find('c', alg);
+        if (!c){
+            fprintf(stderr, "error: algoritmo de compresión '%s' no soportado%s\n",
+                    alg, op == 'd' ? " para -d" : "");
+        }
+        return c;
+    }
+    if (op == 'e' || op == 'u'){
+        if (!opt->key){
+            fprintf(stderr, "error: se pidió -%c pero no se pasó -k clave\n", op);
+            return NULL;
+        }
+        const char *alg = opt->enc_alg ? opt->enc_alg : "vigenere";
+        const gsea_codec_t *c = gsea_codec_find('e', alg);
+        if (!c){
+            fprintf(stderr, "error: algoritmo de encriptación '%s' no soportado%s\n",
+                    alg, op == 'u' ? " para -u" : "");
+        }
+        return c;
+    }
+    fprintf(stderr, "error: operación desconocida '%c'\n", op);
+    return NULL;
+}
@@ -16,34 +16,21 @@ typedef struct HuffNode {
 
 // Cola de prioridad simple para construir el árbol
 typedef struct {
-    HuffNode **nodes;
+    HuffNode *nodes[256];
     int size;
-    int capacity;
 } PriorityQueue;
 
-// Funciones auxiliares para la cola de prioridad
-static PriorityQueue* pq_create(int capacity) {
-    PriorityQueue *pq = malloc(sizeof(PriorityQueue));
-    if (!pq) return NULL;
-    pq->nodes = malloc(sizeof(HuffNode*) * capacity);
-    if (!pq->nodes) {
-        free(pq);
-        return NULL;
-    }
-    pq->size = 0;
-    pq->capacity = capacity;
-    return pq;
-}
+// Un árbol de 256 hojas tiene a lo sumo 511 nodos (+1 por la raíz del caso
+// de un solo byte): alcanza un pool fijo en la pila, sin malloc por nodo
+#define HUFF_MAX_NODES 512
 
-static void pq_free(PriorityQueue *pq) {
-    if (pq) {
-        free(pq->nodes);
-        free(pq);
-    }
-}
+typedef struct {
+    HuffNode nodes[HUFF_MAX_NODES];
+    int used;
+} NodePool;
 
 static void pq_insert(PriorityQueue *pq, HuffNode *node) {
-    if (pq->size >= pq->capacity) return;
+    if (pq->size >= 256) return;
     
     int i = pq->size++;
     while (i > 0) {
@@ -81,9 +68,9 @@ static HuffNode* pq_extract_min(PriorityQueue *pq) {
 }
 
 // Crear nodo del árbol
-static HuffNode* create_node(uint8_t byte, uint32_t freq, HuffNode *left, HuffNode *right) {
-    HuffNode *node = malloc(sizeof(HuffNode));
-    if (!node) return NULL;
+static HuffNode* create_node(NodePool *pool, uint8_t byte, uint32_t freq, HuffNode *left, HuffNode *right) {
+    if (pool->used >= HUFF_MAX_NODES) return NULL;
+    HuffNode *node = &pool->nodes[pool->used++];
     node->byte = byte;
     node->freq = freq;
     node->left = left;
@@ -91,12 +78,35 @@ static HuffNode* create_node(uint8_t byte, uint32_t freq, HuffNode *left, HuffNo
     return node;
 }
 
-// Liberar árbol
-static void free_tree(HuffNode *node) {
-    if (!node) return;
-    free_tree(node->left);
-    free_tree(node->right);
-    free(node);
+// Construir el árbol de Huffman a partir de las frecuencias (igual en
+// compresión y descompresión, así ambos lados obtienen los mismos códigos)
+static HuffNode* build_tree(NodePool *pool, const uint32_t freq[256]) {
+    PriorityQueue pq;
+    pq.size = 0;
+    pool->used = 0;
+    
+    int unique_bytes = 0;
+    for (int i = 0; i < 256; i++) {
+        if (freq[i] > 0) {
+            pq_insert(&pq, create_node(pool, i, freq[i], NULL, NULL));
+            unique_bytes++;
+        }
+    }
+    
+    // Caso especial: solo un byte único
+    if (unique_bytes == 1) {
+        HuffNode *single = pq_extract_min(&pq);
+        pq_insert(&pq, create_node(pool, 0, single->freq, single, NULL));
+    }
+    
+    // Construir árbol combinando nodos
+    while (pq.size > 1) {
+        HuffNode *left = pq_extract_min(&pq);
+        HuffNode *right = pq_extract_min(&pq);
+        pq_insert(&pq, create_node(pool, 0, left->freq + right->freq, left, right));
+    }
+    
+    return pq_extract_min(&pq);
 }
 
 // Construir tabla de códigos
@@ -115,11 +125,15 @@ static void build_codes_recursive(HuffNode *node, uint32_t code, int bits, uint3
         build_codes_recursive(node->right, (code << 1) | 1, bits + 1, codes, code_lens);
 }
 
-// Escribir bits en el buffer
-static void write_bits(uint8_t **out, size_t *out_pos, uint8_t *bit_pos, uint32_t code, uint8_t len) {
+// Escribir bits en el buffer (cada byte se limpia al empezarlo, así el
+// buffer de salida no necesita venir en cero)
+static void write_bits(uint8_t *out, size_t *out_pos, uint8_t *bit_pos, uint32_t code, uint8_t len) {
     for (int i = len - 1; i >= 0; i--) {
+        if (*bit_pos == 0) {
+            out[*out_pos] = 0;
+        }
         if ((code >> i) & 1) {
-            (*out)[*out_pos] |= (1 << (7 - *bit_pos));
+            out[*out_pos] |= (1 << (7 - *bit_pos));
         }
         
         (*bit_pos)++;
@@ -130,13 +144,24 @@ static void write_bits(uint8_t **out, size_t *out_pos, uint8_t *bit_pos, uint32_
     }
 }
 
-int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
-    if (!in || !out || !outn) return -1;
+// Header: 4 bytes (tamaño original) + 256 bytes (longitudes) + 256*4 bytes (frecuencias)
+#define HUFF_HEADER_SIZE (4 + 256 + 256 * 4)
+
+// Huffman es óptimo entre los códigos prefijo y un código fijo de 8 bits es
+// uno de ellos, así que los datos nunca ocupan más de n bytes (con un solo
+// byte distinto el código mide 1 bit)
+size_t huffman_compressed_bound(size_t n) {
+    if (n == 0) return 0;
+    return HUFF_HEADER_SIZE + n;
+}
+
+int huffman_compress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn) {
+    if (!in || !outn) return -1;
     if (n == 0) {
-        *out = malloc(1);
         *outn = 0;
         return 0;
     }
+    if (!out) return -1;
     
     // 1. Calcular frecuencias
     uint32_t freq[256] = {0};
@@ -145,44 +170,8 @@ int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
     }
     
     // 2. Construir árbol de Huffman
-    PriorityQueue *pq = pq_create(256);
-    if (!pq) return -1;
-    
-    int unique_bytes = 0;
-    for (int i = 0; i < 256; i++) {
-        if (freq[i] > 0) {
-            HuffNode *node = create_node(i, freq[i], NULL, NULL);
-            if (!node) {
-                pq_free(pq);
-                return -1;
-            }
-            pq_insert(pq, node);
-            unique_bytes++;
-        }
-    }
-    
-    // Caso especial: solo un byte único
-    if (unique_bytes == 1) {
-        HuffNode *single = pq_extract_min(pq);
-        HuffNode *root = create_node(0, single->freq, single, NULL);
-        pq_insert(pq, root);
-    }
-    
-    // Construir árbol combinando nodos
-    while (pq->size > 1) {
-        HuffNode *left = pq_extract_min(pq);
-        HuffNode *right = pq_extract_min(pq);
-        HuffNode *parent = create_node(0, left->freq + right->freq, left, right);
-        if (!parent) {
-            pq_free(pq);
-            return -1;
-        }
-        pq_insert(pq, parent);
-    }
-    
-    HuffNode *root = pq_extract_min(pq);
-    pq_free(pq);
-    
+    NodePool pool;
+    HuffNode *root = build_tree(&pool, freq);
     if (!root) return -1;
     
     // 3. Generar códigos
@@ -190,35 +179,25 @@ int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
     uint8_t code_lens[256] = {0};
     build_codes_recursive(root, 0, 0, codes, code_lens);
     
-    // 4. Calcular tamaño de salida
-    // Header: 4 bytes (tamaño original) + 256 bytes (longitudes) + 256*4 bytes (frecuencias)
-    size_t header_size = 4 + 256 + 256 * 4;
-    size_t max_data_size = n * 32 / 8 + 100; // Peor caso
-    *out = calloc(1, header_size + max_data_size);
-    if (!*out) {
-        free_tree(root);
-        return -1;
-    }
-    
-    // Escribir header
+    // 4. Escribir header
     size_t pos = 0;
     
     // Tamaño original (4 bytes)
-    (*out)[pos++] = (n >> 24) & 0xFF;
-    (*out)[pos++] = (n >> 16) & 0xFF;
-    (*out)[pos++] = (n >> 8) & 0xFF;
-    (*out)[pos++] = n & 0xFF;
+    out[pos++] = (n >> 24) & 0xFF;
+    out[pos++] = (n >> 16) & 0xFF;
+    out[pos++] = (n >> 8) & 0xFF;
+    out[pos++] = n & 0xFF;
     
     // Longitudes de código (256 bytes)
-    memcpy(*out + pos, code_lens, 256);
+    memcpy(out + pos, code_lens, 256);
     pos += 256;
     
     // Frecuencias (256 * 4 bytes)
     for (int i = 0; i < 256; i++) {
-        (*out)[pos++] = (freq[i] >> 24) & 0xFF;
-        (*out)[pos++] = (freq[i] >> 16) & 0xFF;
-        (*out)[pos++] = (freq[i] >> 8) & 0xFF;
-        (*out)[pos++] = freq[i] & 0xFF;
+        out[pos++] = (freq[i] >> 24) & 0xFF;
+        out[pos++] = (freq[i] >> 16) & 0xFF;
+        out[pos++] = (freq[i] >> 8) & 0xFF;
+        out[pos++] = freq[i] & 0xFF;
     }
     
     // 5. Codificar datos
@@ -230,25 +209,40 @@ int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
     if (bit_pos != 0) pos++; // Ajustar por último byte parcial
     
     *outn = pos;
-    free_tree(root);
+    return 0;
+}
+
+int huffman_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+    if (!in || !out || !outn) return -1;
+    
+    size_t bound = huffman_compressed_bound(n);
+    *out = malloc(bound ? bound : 1);
+    if (!*out) return -1;
     
+    if (huffman_compress_into(in, n, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
     return 0;
 }
 
-int huffman_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+int huffman_decompressed_size(const uint8_t *in, size_t n, size_t *size) {
+    if (!in || !size) return -1;
+    if (n < HUFF_HEADER_SIZE) return -1;
+    *size = ((size_t)in[0] << 24) | ((size_t)in[1] << 16) |
+            ((size_t)in[2] << 8) | in[3];
+    return 0;
+}
+
+int huffman_decompress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn) {
     if (!in || !out || !outn) return -1;
-    if (n < 4 + 256 + 256 * 4) return -1;
     
     // 1. Leer header
-    size_t pos = 0;
-    
-    // Tamaño original
-    size_t orig_size = ((size_t)in[pos] << 24) | ((size_t)in[pos+1] << 16) |
-                       ((size_t)in[pos+2] << 8) | in[pos+3];
-    pos += 4;
+    size_t orig_size;
+    if (huffman_decompressed_size(in, n, &orig_size) != 0) return -1;
+    size_t pos = 4;
     
     if (orig_size == 0) {
-        *out = malloc(1);
         *outn = 0;
         return 0;
     }
@@ -267,52 +261,11 @@ int huffman_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn)
     }
     
     // 2. Reconstruir árbol de Huffman
-    PriorityQueue *pq = pq_create(256);
-    if (!pq) return -1;
-    
-    int unique_bytes = 0;
-    for (int i = 0; i < 256; i++) {
-        if (freq[i] > 0) {
-            HuffNode *node = create_node(i, freq[i], NULL, NULL);
-            if (!node) {
-                pq_free(pq);
-                return -1;
-            }
-            pq_insert(pq, node);
-            unique_bytes++;
-        }
-    }
-    
-    // Caso especial: solo un byte único
-    if (unique_bytes == 1) {
-        HuffNode *single = pq_extract_min(pq);
-        HuffNode *root = create_node(0, single->freq, single, NULL);
-        pq_insert(pq, root);
-    }
-    
-    while (pq->size > 1) {
-        HuffNode *left = pq_extract_min(pq);
-        HuffNode *right = pq_extract_min(pq);
-        HuffNode *parent = create_node(0, left->freq + right->freq, left, right);
-        if (!parent) {
-            pq_free(pq);
-            return -1;
-        }
-        pq_insert(pq, parent);
-    }
-    
-    HuffNode *root = pq_extract_min(pq);
-    pq_free(pq);
-    
+    NodePool pool;
+    HuffNode *root = build_tree(&pool, freq);
     if (!root) return -1;
     
     // 3. Decodificar
-    *out = malloc(orig_size);
-    if (!*out) {
-        free_tree(root);
-        return -1;
-    }
-    
     size_t out_pos = 0;
     HuffNode *current = root;
     
@@ -325,20 +278,33 @@ int huffman_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn)
             }
             
             if (!current) {
-                free(*out);
-                free_tree(root);
                 return -1;
             }
             
             if (!current->left && !current->right) {
-                (*out)[out_pos++] = current->byte;
+                out[out_pos++] = current->byte;
                 current = root;
             }
         }
     }
     
     *outn = orig_size;
-    free_tree(root);
     
     return 0;
 }
+
+int huffman_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+    if (!in || !out || !outn) return -1;
+    
+    size_t orig_size;
+    if (huffman_decompressed_size(in, n, &orig_size) != 0) return -1;
+    
+    *out = malloc(orig_size ? orig_size : 1);
+    if (!*out) return -1;
+    
+    if (huffman_decompress_into(in, n, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
+    return 0;
+}
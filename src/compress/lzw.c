@@ -1,4 +1,5 @@
 #include "lzw.h"
+#include "arena.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -6,44 +7,34 @@
 #define LZW_INIT_CODES 256      // Códigos iniciales (0-255)
 #define LZW_BITS 12             // Bits por código
 
-// Nodo para la tabla hash del compresor
-typedef struct lzw_node {
-    int code;
-    uint8_t byte;
-    struct lzw_node *next;
-    struct lzw_node *children[256];
-} lzw_node_t;
+// Diccionario del compresor: children[c][b] es el código de la cadena c
+// seguida del byte b, o 0 si no existe (0 nunca es hijo: los códigos nuevos
+// empiezan en 256). Vive en la arena del hilo y se recicla entre llamadas.
+typedef uint16_t lzw_children_t[256];
 
-// Tabla del descompresor
+// Tabla del descompresor: cada entrada es (prefijo, último byte), así no
+// hace falta guardar una copia de cada cadena
 typedef struct {
-    uint8_t *data;
-    int len;
+    uint16_t prefix;
+    uint16_t len;
+    uint8_t byte;
+    uint8_t first;
 } lzw_entry_t;
 
 
 typedef struct {
     uint8_t *data;
-    size_t capacity;
     size_t byte_pos;
     int bit_pos;  // posición del bit dentro del byte actual (0-7)
 } bitwriter_t;
 
-static void bw_init(bitwriter_t *bw) {
-    bw->capacity = 1024;
-    bw->data = malloc(bw->capacity);
+static void bw_init(bitwriter_t *bw, uint8_t *data) {
+    bw->data = data;
     bw->byte_pos = 0;
     bw->bit_pos = 0;
 }
 
-static void bw_ensure(bitwriter_t *bw, size_t extra) {
-    while (bw->byte_pos + extra >= bw->capacity) {
-        bw->capacity *= 2;
-        bw->data = realloc(bw->data, bw->capacity);
-    }
-}
-
 static void bw_write_bits(bitwriter_t *bw, uint32_t value, int nbits) {
-    bw_ensure(bw, 4);
     for (int i = nbits - 1; i >= 0; i--) {
         int bit = (value >> i) & 1;
         if (bw->bit_pos == 0) {
@@ -97,77 +88,65 @@ static int br_read_bits(bitreader_t *br, int nbits, uint32_t *out) {
     return 0;
 }
 
-static lzw_node_t* create_node(int code, uint8_t byte) {
-    lzw_node_t *node = calloc(1, sizeof(lzw_node_t));
-    node->code = code;
-    node->byte = byte;
-    return node;
-}
-
-static void free_tree(lzw_node_t *node) {
-    if (!node) return;
-    for (int i = 0; i < 256; i++) {
-        free_tree(node->children[i]);
-    }
-    free(node);
+size_t lzw_compressed_bound(size_t n) {
+    // como mucho un código de 12 bits por byte de entrada; con datos sin
+    // repeticiones (aleatorios) la salida se acerca a esta cota
+    return (n * LZW_BITS + 7) / 8;
 }
 
-int lzw_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+int lzw_compress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn) {
     if (!in || !out || !outn) return -1;
     if (n == 0) {
-        *out = NULL;
         *outn = 0;
         return 0;
     }
 
-    // Inicializar árbol de búsqueda (diccionario)
-    lzw_node_t *root = create_node(-1, 0);
-    for (int i = 0; i < 256; i++) {
-        root->children[i] = create_node(i, (uint8_t)i);
-    }
+    gsea_arena_t *arena = gsea_arena_thread();
+    gsea_arena_mark_t mark = gsea_arena_mark(arena);
+    lzw_children_t *children = gsea_arena_alloc(arena, (LZW_MAX_CODE + 1) * sizeof(lzw_children_t));
+    if (!children) return -1;
+
+    // Inicializar diccionario: solo las filas de los códigos de un byte;
+    // las demás se limpian al crear cada código
+    memset(children, 0, LZW_INIT_CODES * sizeof(lzw_children_t));
 
     bitwriter_t bw;
-    bw_init(&bw);
+    bw_init(&bw, out);
 
     int next_code = LZW_INIT_CODES;
-    lzw_node_t *current = root;
+    uint16_t current = in[0];
     
-    for (size_t i = 0; i < n; i++) {
+    for (size_t i = 1; i < n; i++) {
         uint8_t byte = in[i];
         
         // Buscar en el diccionario
-        if (current->children[byte] != NULL) {
-            current = current->children[byte];
+        if (children[current][byte] != 0) {
+            current = children[current][byte];
         } else {
             // Emitir código del prefijo
-            bw_write_bits(&bw, current->code, LZW_BITS);
+            bw_write_bits(&bw, current, LZW_BITS);
             
             // Agregar nueva entrada si hay espacio
             if (next_code <= LZW_MAX_CODE) {
-                current->children[byte] = create_node(next_code, byte);
+                memset(children[next_code], 0, sizeof(lzw_children_t));
+                children[current][byte] = (uint16_t)next_code;
                 next_code++;
             }
             
             // Reiniciar con el byte actual
-            current = root->children[byte];
+            current = byte;
         }
     }
     
     // Emitir el último código
-    if (current != root) {
-        bw_write_bits(&bw, current->code, LZW_BITS);
-    }
+    bw_write_bits(&bw, current, LZW_BITS);
 
-    size_t final_size = bw_finalize(&bw);
-    *out = bw.data;
-    *outn = final_size;
-
-    free_tree(root);
+    *outn = bw_finalize(&bw);
+    gsea_arena_release(arena, mark);
     return 0;
 }
 
-
-int lzw_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+int lzw_compress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
     if (!in || !out || !outn) return -1;
     if (n == 0) {
         *out = NULL;
@@ -175,107 +154,113 @@ int lzw_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
         return 0;
     }
 
-    // Inicializar tabla de descompresión
-    lzw_entry_t *table = malloc((LZW_MAX_CODE + 1) * sizeof(lzw_entry_t));
-    if (!table) return -1;
+    *out = malloc(lzw_compressed_bound(n));
+    if (!*out) return -1;
+    if (lzw_compress_into(in, n, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
+    return 0;
+}
 
+// Recorre los códigos reconstruyendo la tabla; si out es NULL solo calcula
+// el tamaño de la salida (la tabla guarda las longitudes, no los datos)
+static int lzw_decode(const uint8_t *in, size_t n, uint8_t *out, size_t *outn) {
+    lzw_entry_t table[LZW_MAX_CODE + 1];
     for (int i = 0; i < LZW_INIT_CODES; i++) {
-        table[i].data = malloc(1);
-        table[i].data[0] = (uint8_t)i;
+        table[i].prefix = 0;
         table[i].len = 1;
+        table[i].byte = (uint8_t)i;
+        table[i].first = (uint8_t)i;
     }
-    
     int next_code = LZW_INIT_CODES;
 
-    // Buffer de salida dinámico
-    size_t out_cap = n * 2;  // estimación
-    size_t out_len = 0;
-    uint8_t *outbuf = malloc(out_cap);
-    if (!outbuf) {
-        free(table);
-        return -1;
-    }
-
     bitreader_t br;
     br_init(&br, in, n);
 
-    uint32_t prev_code;
-    if (br_read_bits(&br, LZW_BITS, &prev_code) != 0 || prev_code >= LZW_INIT_CODES) {
-        free(outbuf);
-        for (int i = 0; i < next_code; i++) free(table[i].data);
-        free(table);
-        return -1;
-    }
-
-    // Escribir primer código
-    if (out_len + table[prev_code].len > out_cap) {
-        out_cap *= 2;
-        outbuf = realloc(outbuf, out_cap);
-    }
-    memcpy(outbuf + out_len, table[prev_code].data, table[prev_code].len);
-    out_len += table[prev_code].len;
+    size_t out_len = 0;
+    uint32_t prev_code = 0;
+    int have_prev = 0;
 
-    // Procesar códigos restantes
     while (1) {
         uint32_t code;
         if (br_read_bits(&br, LZW_BITS, &code) != 0) {
             break;  // fin de datos
         }
 
-        uint8_t *entry_data;
-        int entry_len;
-
-        if (code < (uint32_t)next_code) {
-            // Código existente
-            entry_data = table[code].data;
-            entry_len = table[code].len;
-        } else if (code == (uint32_t)next_code) {
-            // Caso especial: código no existe aún
-            entry_len = table[prev_code].len + 1;
-            entry_data = malloc(entry_len);
-            memcpy(entry_data, table[prev_code].data, table[prev_code].len);
-            entry_data[entry_len - 1] = table[prev_code].data[0];
+        if (!have_prev) {
+            if (code >= LZW_INIT_CODES) return -1;
+        } else if (code <= (uint32_t)next_code) {
+            // Agregar nueva entrada: prefijo previo + primer byte de la
+            // cadena actual (si code == next_code es el caso cadena+cadena[0])
+            if (next_code <= LZW_MAX_CODE) {
+                lzw_entry_t *e = &table[next_code];
+                e->prefix = (uint16_t)prev_code;
+                e->len = table[prev_code].len + 1;
+                e->first = table[prev_code].first;
+                e->byte = code == (uint32_t)next_code ? e->first : table[code].first;
+                next_code++;
+            }
         } else {
             // Código inválido
-            free(outbuf);
-            for (int i = 0; i < next_code; i++) free(table[i].data);
-            free(table);
             return -1;
         }
-
-        // Escribir salida
-        if (out_len + entry_len > out_cap) {
-            while (out_len + entry_len > out_cap) out_cap *= 2;
-            outbuf = realloc(outbuf, out_cap);
-        }
-        memcpy(outbuf + out_len, entry_data, entry_len);
-        out_len += entry_len;
-
-        // Agregar nueva entrada a la tabla
-        if (next_code <= LZW_MAX_CODE) {
-            table[next_code].len = table[prev_code].len + 1;
-            table[next_code].data = malloc(table[next_code].len);
-            memcpy(table[next_code].data, table[prev_code].data, table[prev_code].len);
-            table[next_code].data[table[next_code].len - 1] = entry_data[0];
-            next_code++;
-        }
-
-        if (code == (uint32_t)(next_code - 1) && code != prev_code) {
-            // Liberamos el entry_data temporal del caso especial
-            // (ya fue copiado a la tabla)
+        if (code >= (uint32_t)next_code) return -1;
+
+        // Escribir salida de atrás hacia adelante siguiendo los prefijos
+        size_t len = table[code].len;
+        if (out) {
+            uint32_t c = code;
+            for (size_t k = len; k > 0; k--) {
+                out[out_len + k - 1] = table[c].byte;
+                c = table[c].prefix;
+            }
         }
+        out_len += len;
 
         prev_code = code;
+        have_prev = 1;
     }
 
-    *out = outbuf;
+    if (!have_prev) return -1;
     *outn = out_len;
+    return 0;
+}
 
-    // Liberar tabla
-    for (int i = 0; i < next_code; i++) {
-        free(table[i].data);
+int lzw_decompressed_size(const uint8_t *in, size_t n, size_t *size) {
+    if (!in || !size) return -1;
+    if (n == 0) {
+        *size = 0;
+        return 0;
     }
-    free(table);
+    return lzw_decode(in, n, NULL, size);
+}
 
+int lzw_decompress_into(const uint8_t *in, size_t n, uint8_t *out, size_t *outn) {
+    if (!in || !outn) return -1;
+    if (n == 0) {
+        *outn = 0;
+        return 0;
+    }
+    if (!out) return -1;
+    return lzw_decode(in, n, out, outn);
+}
+
+int lzw_decompress(const uint8_t *in, size_t n, uint8_t **out, size_t *outn) {
+    if (!in || !out || !outn) return -1;
+    if (n == 0) {
+        *out = NULL;
+        *outn = 0;
+        return 0;
+    }
+
+    size_t size;
+    if (lzw_decompressed_size(in, n, &size) != 0) return -1;
+    *out = malloc(size ? size : 1);
+    if (!*out) return -1;
+    if (lzw_decompress_into(in, n, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
     return 0;
 }
@@ -1,26 +1,51 @@
 #include "rle.h"
 #include <stdlib.h>
-int rle_compress(const unsigned char *in, size_t n, unsigned char **out, size_t *outn){
-  if (!n){ *out=NULL; *outn=0; return 0; }
-  unsigned char *buf = malloc(n*2); if(!buf) return -1;
+size_t rle_compressed_bound(size_t n){
+  return n*2;
+}
+size_t rle_compressed_size(const unsigned char *in, size_t n){
+  size_t runs=0;
+  for (size_t i=0;i<n;){
+    unsigned char v = in[i]; size_t run=1;
+    while (i+run<n && in[i+run]==v && run<255) run++;
+    runs++;
+    i += run;
+  }
+  return runs*2;
+}
+int rle_compress_into(const unsigned char *in, size_t n, unsigned char *out, size_t *outn){
   size_t j=0;
   for (size_t i=0;i<n;){
     unsigned char v = in[i]; size_t run=1;
     while (i+run<n && in[i+run]==v && run<255) run++;
-    buf[j++] = (unsigned char)run;
-    buf[j++] = v;
+    out[j++] = (unsigned char)run;
+    out[j++] = v;
     i += run;
   }
-  *out = buf; *outn = j; return 0;
+  *outn = j; return 0;
 }
-int rle_decompress(const unsigned char *in, size_t n, unsigned char **out, size_t *outn){
+int rle_compress(const unsigned char *in, size_t n, unsigned char **out, size_t *outn){
+  if (!n){ *out=NULL; *outn=0; return 0; }
+  unsigned char *buf = malloc(rle_compressed_size(in, n)); if(!buf) return -1;
+  rle_compress_into(in, n, buf, outn);
+  *out = buf; return 0;
+}
+size_t rle_decompressed_size(const unsigned char *in, size_t n){
   size_t est=0;
   for (size_t k=0;k+1<n;k+=2) est += in[k];
-  unsigned char *buf = malloc(est); if(!buf) return -1;
+  return est;
+}
+int rle_decompress_into(const unsigned char *in, size_t n, unsigned char *out, size_t *outn){
   size_t j=0;
   for (size_t i=0;i+1<n;i+=2){
     unsigned char cnt = in[i], val = in[i+1];
-    for (int c=0;c<cnt;c++) buf[j++]=val;
+    for (int c=0;c<cnt;c++) out[j++]=val;
   }
-  *out=buf; *outn=j; return 0;
+  *outn=j; return 0;
+}
+int rle_decompress(const unsigned char *in, size_t n, unsigned char **out, size_t *outn){
+  size_t est = rle_decompressed_size(in, n);
+  unsigned char *buf = malloc(est ? est : 1); if(!buf) return -1;
+  rle_decompress_into(in, n, buf, outn);
+  *out=buf; return 0;
 }
@@ -0,0 +1,226 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "container.h"
+#include "stream.h"
+
+size_t gsea_header_size(const gsea_header_t *hdr){
+    return GSEA_HDR_FIXED + 2 * (size_t)hdr->nsteps;
+}
+
+int gsea_header_write(int fd, const gsea_header_t *hdr){
+    uint8_t buf[GSEA_HDR_FIXED + 2 * GSEA_MAX_STEPS];
+    memcpy(buf, GSEA_MAGIC, GSEA_MAGIC_LEN);
+    buf[8] = GSEA_VERSION;
+    buf[9] = hdr->flags;
+    buf[10] = (uint8_t)hdr->nsteps;
+    buf[11] = 0;
+    for (int i = 0; i < 4; i++){
+        buf[12 + i] = (uint8_t)(hdr->chunk_size >> (24 - 8 * i));
+    }
+    for (int i = 0; i < 8; i++){
+        buf[16 + i] = (uint8_t)(hdr->orig_size >> (56 - 8 * i));
+    }
+    for (int i = 0; i < hdr->nsteps; i++){
+        buf[GSEA_HDR_FIXED + 2 * i] = (uint8_t)hdr->steps[i].op;
+        buf[GSEA_HDR_FIXED + 2 * i + 1] = hdr->steps[i].alg;
+    }
+    return gsea_write_full(fd, buf, gsea_header_size(hdr));
+}
+
+void gsea_header_patch_size(int fd, uint64_t orig_size){
+    uint8_t buf[8];
+    for (int i = 0; i < 8; i++){
+        buf[i] = (uint8_t)(orig_size >> (56 - 8 * i));
+    }
+    // en pipes falla con ESPIPE y el header queda con UINT64_MAX
+    if (pwrite(fd, buf, sizeof(buf), 16) != (ssize_t)sizeof(buf) && errno != ESPIPE){
+        perror("pwrite header");
+    }
+}
+
+int gsea_container_probe(int fd, gsea_header_t *hdr, uint8_t *pre, size_t *pre_len){
+    uint8_t buf[GSEA_HDR_FIXED + 2 * GSEA_MAX_STEPS];
+    int seq = 0;
+    *pre_len = 0;
+
+    ssize_t r = pread(fd, buf, GSEA_HDR_FIXED, 0);
+    if (r < 0 && errno == ESPIPE){
+        // pipe: se lee en orden y, si no es contenedor, lo leído vuelve en 'pre'
+        seq = 1;
+        r = gsea_read_full(fd, buf, GSEA_HDR_FIXED);
+        if (r < 0){
+            perror("read");
+            return -1;
+        }
+        if (r < GSEA_HDR_FIXED || memcmp(buf, GSEA_MAGIC, GSEA_MAGIC_LEN) != 0){
+            memcpy(pre, buf, (size_t)r);
+            *pre_len = (size_t)r;
+            return 0;
+        }
+    } else if (r < GSEA_HDR_FIXED || memcmp(buf, GSEA_MAGIC, GSEA_MAGIC_LEN) != 0){
+        return 0;
+    }
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->version = buf[8];
+    hdr->flags = buf[9];
+    hdr->nsteps = buf[10];
+    if (hdr->version < GSEA_VERSION_MIN || hdr->version > GSEA_VERSION){
+        fprintf(stderr, "error: versión de contenedor %u no soportada\n", hdr->version);
+        return -1;
+    }
+    if (hdr->nsteps > GSEA_MAX_STEPS){
+        fprintf(stderr, "error: header de contenedor inválido\n");
+        return -1;
+    }
+    for (int i = 0; i < 4; i++){
+        hdr->chunk_size = (hdr->chunk_size << 8) | buf[12 + i];
+    }
+    for (int i = 0; i < 8; i++){
+        hdr->orig_size = (hdr->orig_size << 8) | buf[16 + i];
+    }
+    // ningún escritor usa bloques más grandes; acota los frames (ver stream.c)
+    if (hdr->chunk_size > GSEA_MAX_CHUNK){
+        fprintf(stderr, "error: header de contenedor inválido\n");
+        return -1;
+    }
+
+    size_t steps_len = 2 * (size_t)hdr->nsteps;
+    int trunc = seq
+        ? gsea_read_full(fd, buf + GSEA_HDR_FIXED, steps_len) != (ssize_t)steps_len
+        : gsea_pread_full(fd, buf + GSEA_HDR_FIXED, steps_len, GSEA_HDR_FIXED) != 0;
+    if (trunc){
+        fprintf(stderr, "error: header de contenedor truncado\n");
+        return -1;
+    }
+    for (int i = 0; i < hdr->nsteps; i++){
+        hdr->steps[i].op = (char)buf[GSEA_HDR_FIXED + 2 * i];
+        hdr->steps[i].alg = buf[GSEA_HDR_FIXED + 2 * i + 1];
+        const gsea_codec_t *c = gsea_codec_by_id(hdr->steps[i].alg);
+        if (!c || c->kind != hdr->steps[i].op){
+            fprintf(stderr, "error: algoritmo desconocido en el contenedor\n");
+            return -1;
+        }
+    }
+
+    if (!seq && lseek(fd, (off_t)gsea_header_size(hdr), SEEK_SET) < 0){
+        perror("lseek");
+        return -1;
+    }
+    return 1;
+}
+
+int gsea_plan_build(const gsea_opts_t *opt, int framed_in,
+                    const gsea_header_t *in_hdr, size_t chunk, gsea_plan_t *plan){
+    memset(plan, 0, sizeof(*plan));
+    plan->framed_in = framed_in;
+
+    // la pila parte de la cadena registrada en la entrada
+    gsea_header_t *out = &plan->out_hdr;
+    if (framed_in){
+        plan->in_hdr = *in_hdr;
+        *out = *in_hdr;
+        // el CRC del original solo sigue valiendo si la entrada lo traía
+        if (in_hdr->version < 2) out->flags &= (uint8_t)~GSEA_HDR_RAW_CRC;
+    } else {
+        out->chunk_size = (uint32_t)chunk;
+        out->flags = GSEA_HDR_RAW_CRC;
+    }
+    out->version = GSEA_VERSION;
+    out->orig_size = UINT64_MAX;
+
+    // --range/--verify/--member/--list/--dedup sin -d/-u: deshacer la
+    // cadena completa registrada
+    char undo[GSEA_MAX_STEPS];
+    const char *ops = opt->ops_order;
+    int nops = opt->ops_count;
+    if (nops == 0 && framed_in &&
+        (opt->has_range || opt->verify || opt->member || opt->list || opt->dedup)){
+        for (int i = 0; i < in_hdr->nsteps; i++){
+            undo[i] = in_hdr->steps[in_hdr->nsteps - 1 - i].op == 'c' ? 'd' : 'u';
+        }
+        ops = undo;
+        nops = in_hdr->nsteps;
+    }
+
+    for (int i = 0; i < nops; i++){
+        char op = ops[i];
+        gsea_step_t st = { op, 0 };
+
+        if (op == 'c' || op == 'e'){
+            const gsea_codec_t *c = gsea_codec_for_op(opt, op);
+            if (!c) return -1;
+            if (!(c->flags & GSEA_CODEC_STREAMING)){
+                fprintf(stderr, "error: '%s' no se puede aplicar por bloques\n", c->name);
+                return -1;
+            }
+            st.alg = c->id;
+            if (out->nsteps == GSEA_MAX_STEPS){
+                fprintf(stderr, "error: demasiadas operaciones encadenadas\n");
+                return -1;
+            }
+            out->steps[out->nsteps++] = st;
+        } else {
+            char want = op == 'd' ? 'c' : 'e';
+            if (out->nsteps == 0 || out->steps[out->nsteps - 1].op != want){
+                fprintf(stderr,
+                        "error: -%c no corresponde a la cadena del contenedor "
+                        "(debe deshacerse en orden inverso)\n", op);
+                return -1;
+            }
+            st.alg = out->steps[--out->nsteps].alg;
+        }
+        plan->steps[plan->nsteps++] = st;
+    }
+
+    plan->framed_out = out->nsteps > 0;
+    return 0;
+}
+
+// peor cota de forward del paso 'st' sobre n bytes (SIZE_MAX si no la da)
+static size_t step_worst(const gsea_step_t *st, size_t n){
+    const gsea_codec_t *c = gsea_codec_by_id(st->alg);
+    size_t b;
+    if (!c || c->forward_bound(NULL, n, &b) != 0) return SIZE_MAX;
+    return b;
+}
+
+// Tope de la salida de cada paso del plan sobre un frame cuyo original mide
+// raw_len: deshacer un paso del contenedor no puede dar más de lo que ese
+// paso recibió, que como mucho es raw_len agrandado por los pasos de abajo
+static void plan_limits(const gsea_plan_t *plan, uint32_t raw_len, int to, size_t *limit){
+    size_t sz[GSEA_MAX_STEPS + 1];
+    int top = 0;
+    sz[0] = raw_len;
+    for (int i = 0; i < plan->in_hdr.nsteps; i++, top++){
+        sz[top + 1] = step_worst(&plan->in_hdr.steps[i], sz[top]);
+    }
+    for (int i = 0; i < to; i++){
+        if (!gsea_step_inverse(plan->steps[i].op)){
+            sz[top + 1] = step_worst(&plan->steps[i], sz[top]);
+            top++;
+            limit[i] = SIZE_MAX;
+        } else {
+            limit[i] = top > 0 ? sz[--top] : SIZE_MAX;
+        }
+    }
+}
+
+int gsea_plan_apply(const gsea_plan_t *plan, const gsea_opts_t *opt,
+                    uint32_t raw_len, int from, int to,
+                    const uint8_t *in, size_t n, uint8_t **out, size_t *outn){
+    size_t limit[GSEA_MAX_STEPS];
+    if (!plan->framed_in){
+        return gsea_apply_steps(plan->steps + from, to - from, opt->key, NULL,
+                                in, n, out, outn);
+    }
+    plan_limits(plan, raw_len, to, limit);
+    return gsea_apply_steps(plan->steps + from, to - from, opt->key, limit + from,
+                            in, n, out, outn);
+}
@@ -0,0 +1,161 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include "cpus.h"
+
+static int cpu_count;
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+
+// punto de montaje de un tipo de fs; con 'opt' además debe figurar esa opción
+static int find_mount(const char *type, const char *opt, char *mnt, size_t mntlen){
+    FILE *f = fopen("/proc/self/mounts", "r");
+    if (!f) return -1;
+    char line[1024];
+    int found = -1;
+    while (found != 0 && fgets(line, sizeof(line), f)){
+        char dev[256], dir[512], fstype[64], opts[512];
+        if (sscanf(line, "%255s %511s %63s %511s", dev, dir, fstype, opts) != 4) continue;
+        if (strcmp(fstype, type) != 0) continue;
+        if (opt){
+            int has = 0;
+            for (char *save = NULL, *t = strtok_r(opts, ",", &save); t;
+                 t = strtok_r(NULL, ",", &save)){
+                if (strcmp(t, opt) == 0) has = 1;
+            }
+            if (!has) continue;
+        }
+        snprintf(mnt, mntlen, "%s", dir);
+        found = 0;
+    }
+    fclose(f);
+    return found;
+}
+
+// ruta del cgroup del proceso: la jerarquía v2 ("0::") o la v1 con 'ctrl'
+static int self_cgroup(const char *ctrl, char *path, size_t pathlen){
+    FILE *f = fopen("/proc/self/cgroup", "r");
+    if (!f) return -1;
+    char line[1024];
+    int found = -1;
+    while (found != 0 && fgets(line, sizeof(line), f)){
+        line[strcspn(line, "\n")] = '\0';
+        char *c1 = strchr(line, ':');
+        char *c2 = c1 ? strchr(c1 + 1, ':') : NULL;
+        if (!c2) continue;
+        *c2 = '\0';
+        const char *ctrls = c1 + 1;
+        int match = 0;
+        if (!ctrl){
+            match = c1 == line + 1 && line[0] == '0' && *ctrls == '\0';
+        } else {
+            char buf[256];
+            snprintf(buf, sizeof(buf), "%s", ctrls);
+            for (char *save = NULL, *t = strtok_r(buf, ",", &save); t;
+                 t = strtok_r(NULL, ",", &save)){
+                if (strcmp(t, ctrl) == 0) match = 1;
+            }
+        }
+        if (match){
+            snprintf(path, pathlen, "%s", c2 + 1);
+            found = 0;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+// cuota en CPUs de un directorio de cgroup; 0 si no hay límite o no existe
+static double read_quota(const char *dir, int v2){
+    char file[1232];              // dir (hasta 1200) + "/cpu.cfs_period_us"
+    double quota = 0;
+    if (v2){
+        snprintf(file, sizeof(file), "%s/cpu.max", dir);
+        FILE *f = fopen(file, "r");
+        if (!f) return 0;
+        char q[32];
+        long period;
+        if (fscanf(f, "%31s %ld", q, &period) == 2 && strcmp(q, "max") != 0 && period > 0){
+            quota = strtod(q, NULL) / (double)period;
+        }
+        fclose(f);
+    } else {
+        long q = -1, period = 0;
+        snprintf(file, sizeof(file), "%s/cpu.cfs_quota_us", dir);
+        FILE *f = fopen(file, "r");
+        if (!f) return 0;
+        if (fscanf(f, "%ld", &q) != 1) q = -1;
+        fclose(f);
+        snprintf(file, sizeof(file), "%s/cpu.cfs_period_us", dir);
+        f = fopen(file, "r");
+        if (!f) return 0;
+        if (fscanf(f, "%ld", &period) != 1) period = 0;
+        fclose(f);
+        if (q > 0 && period > 0) quota = (double)q / (double)period;
+    }
+    return quota;
+}
+
+// menor cuota desde el cgroup del proceso hasta la raíz de la jerarquía
+static double hierarchy_quota(const char *mnt, const char *cg, int v2){
+    // dentro de un contenedor la ruta puede no existir en este namespace
+    // (el montaje ya es el cgroup propio): se sube hasta la raíz
+    char dir[1200];
+    snprintf(dir, sizeof(dir), "%s%s", mnt, strcmp(cg, "/") == 0 ? "" : cg);
+    size_t root = strlen(mnt);
+    double best = 0;
+    for (;;){
+        double q = read_quota(dir, v2);
+        if (q > 0 && (best == 0 || q < best)) best = q;
+        char *slash = strrchr(dir, '/');
+        if (strlen(dir) <= root || !slash || (size_t)(slash - dir) < root) break;
+        *slash = '\0';
+    }
+    return best;
+}
+
+static double cgroup_quota(void){
+    char mnt[512], cg[512];
+    double q = 0;
+    if (find_mount("cgroup2", NULL, mnt, sizeof(mnt)) == 0 &&
+        self_cgroup(NULL, cg, sizeof(cg)) == 0){
+        q = hierarchy_quota(mnt, cg, 1);
+    }
+    // en modo híbrido el controlador cpu puede seguir en la jerarquía v1
+    if (q == 0 && find_mount("cgroup", "cpu", mnt, sizeof(mnt)) == 0 &&
+        self_cgroup("cpu", cg, sizeof(cg)) == 0){
+        q = hierarchy_quota(mnt, cg, 0);
+    }
+    return q;
+}
+
+static void cpu_init(void){
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int n = online > 0 ? (int)online : 1;
+
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0){
+        int aff = CPU_COUNT(&set);
+        if (aff > 0 && aff < n) n = aff;
+    }
+
+    double quota = cgroup_quota();
+    if (quota > 0){
+        int q = (int)quota;
+        if ((double)q < quota) q++;           // 1.5 CPUs -> 2 workers
+        if (q < n) n = q;
+    }
+    cpu_count = n > 0 ? n : 1;
+}
+
+int gsea_cpu_count(void){
+    pthread_once(&cpu_once, cpu_init);
+    return cpu_count;
+}
+
+int gsea_jobs(const gsea_opts_t *opt){
+    return opt && opt->jobs > 0 ? opt->jobs : gsea_cpu_count();
+}
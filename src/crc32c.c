@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "crc32c.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC_HAVE_SSE42 1
+#endif
+
+#define CRC32C_POLY 0x82F63B78u
+
+typedef uint32_t (*crc_fn)(uint32_t crc, const uint8_t *p, size_t n);
+
+// tablas slicing-by-8: table[k][b] es el CRC del byte b seguido de k ceros
+static uint32_t table[8][256];
+static crc_fn impl;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+
+static uint32_t crc_sw(uint32_t crc, const uint8_t *p, size_t n){
+    // hasta alinear a 8 de a un byte
+    while (n > 0 && ((uintptr_t)p & 7) != 0){
+        crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        n--;
+    }
+    while (n >= 8){
+        // little-endian: los primeros 4 bytes se combinan con el CRC
+        uint32_t lo = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                      ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        lo ^= crc;
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^
+              table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+              table[3][p[4]] ^ table[2][p[5]] ^
+              table[1][p[6]] ^ table[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n > 0){
+        crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        n--;
+    }
+    return crc;
+}
+
+#ifdef CRC_HAVE_SSE42
+__attribute__((target("sse4.2")))
+static uint32_t crc_hw(uint32_t crc, const uint8_t *p, size_t n){
+    while (n > 0 && ((uintptr_t)p & 7) != 0){
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+#ifdef __x86_64__
+    uint64_t c = crc;
+    while (n >= 8){
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        n -= 8;
+    }
+    crc = (uint32_t)c;
+#endif
+    while (n >= 4){
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        n -= 4;
+    }
+    while (n > 0){
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+    return crc;
+}
+#endif
+
+static void crc_init(void){
+    for (uint32_t b = 0; b < 256; b++){
+        uint32_t c = b;
+        for (int k = 0; k < 8; k++){
+            c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        }
+        table[0][b] = c;
+    }
+    for (int k = 1; k < 8; k++){
+        for (int b = 0; b < 256; b++){
+            uint32_t c = table[k - 1][b];
+            table[k][b] = table[0][c & 0xFF] ^ (c >> 8);
+        }
+    }
+
+    impl = crc_sw;
+#ifdef CRC_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) impl = crc_hw;
+#endif
+}
+
+uint32_t gsea_crc32c_update(uint32_t crc, const void *buf, size_t n){
+    pthread_once(&init_once, crc_init);
+    return ~impl(~crc, buf, n);
+}
+
+int gsea_crc32c_hw(void){
+    pthread_once(&init_once, crc_init);
+#ifdef CRC_HAVE_SSE42
+    return impl == crc_hw;
+#else
+    return 0;
+#endif
+}
@@ -213,9 +213,13 @@ static void aes_decrypt_block(uint8_t *block, const uint8_t round_keys[][16], in
     add_round_key(block, round_keys[0]);
 }
 
-int aes_encrypt(const uint8_t *in, size_t n,
-                const uint8_t *key, size_t klen,
-                uint8_t **out, size_t *outn) {
+size_t aes_encrypted_size(size_t n) {
+    return n + (16 - (n % 16));
+}
+
+int aes_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn) {
     if (!in || !key || !out || !outn) return -1;
     if (klen < 16) {
         fprintf(stderr, "Error: clave AES debe tener al menos 16 bytes\n");
@@ -226,13 +230,10 @@ int aes_encrypt(const uint8_t *in, size_t n,
     size_t pad_len = 16 - (n % 16);
     size_t total_len = n + pad_len;
     
-    *out = malloc(total_len);
-    if (!*out) return -1;
-    
-    // Copiar datos y aplicar padding
-    memcpy(*out, in, n);
+    // Copiar datos y aplicar padding (memmove: in y out pueden coincidir)
+    memmove(out, in, n);
     for (size_t i = n; i < total_len; i++) {
-        (*out)[i] = (uint8_t)pad_len;
+        out[i] = (uint8_t)pad_len;
     }
     
     // Generar claves de ronda
@@ -243,16 +244,16 @@ int aes_encrypt(const uint8_t *in, size_t n,
     
     // Cifrar cada bloque de 16 bytes
     for (size_t i = 0; i < total_len; i += 16) {
-        aes_encrypt_block(*out + i, round_keys, 11);
+        aes_encrypt_block(out + i, round_keys, 11);
     }
     
     *outn = total_len;
     return 0;
 }
 
-int aes_decrypt(const uint8_t *in, size_t n,
-                const uint8_t *key, size_t klen,
-                uint8_t **out, size_t *outn) {
+int aes_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn) {
     if (!in || !key || !out || !outn) return -1;
     if (klen < 16) {
         fprintf(stderr, "Error: clave AES debe tener al menos 16 bytes\n");
@@ -263,9 +264,7 @@ int aes_decrypt(const uint8_t *in, size_t n,
         return -1;
     }
     
-    *out = malloc(n);
-    if (!*out) return -1;
-    memcpy(*out, in, n);
+    memmove(out, in, n);
     
     // Generar claves de ronda
     uint8_t round_keys[11][16];
@@ -275,21 +274,19 @@ int aes_decrypt(const uint8_t *in, size_t n,
     
     // Descifrar cada bloque de 16 bytes
     for (size_t i = 0; i < n; i += 16) {
-        aes_decrypt_block(*out + i, round_keys, 11);
+        aes_decrypt_block(out + i, round_keys, 11);
     }
     
     // Verificar y remover padding PKCS#7
-    uint8_t pad_len = (*out)[n - 1];
+    uint8_t pad_len = out[n - 1];
     if (pad_len > 16 || pad_len == 0) {
-        free(*out);
         fprintf(stderr, "Error: padding inválido\n");
         return -1;
     }
     
     // Verificar que todos los bytes de padding sean correctos
     for (size_t i = n - pad_len; i < n; i++) {
-        if ((*out)[i] != pad_len) {
-            free(*out);
+        if (out[i] != pad_len) {
             fprintf(stderr, "Error: padding corrupto\n");
             return -1;
         }
@@ -298,3 +295,33 @@ int aes_decrypt(const uint8_t *in, size_t n,
     *outn = n - pad_len;
     return 0;
 }
+
+int aes_encrypt(const uint8_t *in, size_t n,
+                const uint8_t *key, size_t klen,
+                uint8_t **out, size_t *outn) {
+    if (!in || !key || !out || !outn) return -1;
+    
+    *out = malloc(aes_encrypted_size(n));
+    if (!*out) return -1;
+    
+    if (aes_encrypt_into(in, n, key, klen, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
+    return 0;
+}
+
+int aes_decrypt(const uint8_t *in, size_t n,
+                const uint8_t *key, size_t klen,
+                uint8_t **out, size_t *outn) {
+    if (!in || !key || !out || !outn) return -1;
+    
+    *out = malloc(n ? n : 1);
+    if (!*out) return -1;
+    
+    if (aes_decrypt_into(in, n, key, klen, *out, outn) != 0) {
+        free(*out);
+        return -1;
+    }
+    return 0;
+}
@@ -301,9 +301,13 @@ static void des_block(const uint8_t *input, const uint8_t subkeys[16][6],
 // FUNCIONES PÚBLICAS
 // ============================================================================
 
-int des_encrypt(const uint8_t *in, size_t n,
-                const uint8_t *key, size_t klen,
-                uint8_t **out, size_t *outn) {
+size_t des_encrypted_size(size_t n) {
+    return n + (8 - (n % 8));
+}
+
+int des_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn) {
     if (!in || !key || !out || !outn) return -1;
     if (klen < 8) return -1;
     
@@ -315,13 +319,11 @@ int des_encrypt(const uint8_t *in, size_t n,
     size_t pad_len = 8 - (n % 8);
     size_t total_len = n + pad_len;
     
-    uint8_t *outbuf = malloc(total_len);
-    if (!outbuf) return -1;
-    
-    // Procesar bloques completos
+    // Procesar bloques completos (des_block copia la entrada antes de
+    // escribir, así que in y out pueden coincidir)
     size_t blocks = n / 8;
     for (size_t i = 0; i < blocks; i++) {
-        des_block(in + i * 8, subkeys, outbuf + i * 8, 0);
+        des_block(in + i * 8, subkeys, out + i * 8, 0);
     }
     
     // Último bloque con padding
@@ -333,16 +335,15 @@ int des_encrypt(const uint8_t *in, size_t n,
     for (size_t i = remaining; i < 8; i++) {
         last_block[i] = (uint8_t)pad_len;
     }
-    des_block(last_block, subkeys, outbuf + blocks * 8, 0);
+    des_block(last_block, subkeys, out + blocks * 8, 0);
     
-    *out = outbuf;
     *outn = total_len;
     return 0;
 }
 
-int des_decrypt(const uint8_t *in, size_t n,
-                const uint8_t *key, size_t klen,
-                uint8_t **out, size_t *outn) {
+int des_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out, size_t *outn) {
     if (!in || !key || !out || !outn) return -1;
     if (klen < 8 || n == 0 || n % 8 != 0) return -1;
     
@@ -350,31 +351,57 @@ int des_decrypt(const uint8_t *in, size_t n,
     uint8_t subkeys[16][6];
     generate_subkeys(key, subkeys);
     
-    uint8_t *outbuf = malloc(n);
-    if (!outbuf) return -1;
-    
     // Descifrar todos los bloques
     size_t blocks = n / 8;
     for (size_t i = 0; i < blocks; i++) {
-        des_block(in + i * 8, subkeys, outbuf + i * 8, 1);
+        des_block(in + i * 8, subkeys, out + i * 8, 1);
     }
     
     // Remover padding PKCS#7
-    uint8_t pad_len = outbuf[n - 1];
+    uint8_t pad_len = out[n - 1];
     if (pad_len < 1 || pad_len > 8) {
-        free(outbuf);
         return -1;
     }
     
     // Verificar padding
     for (size_t i = 0; i < pad_len; i++) {
-        if (outbuf[n - 1 - i] != pad_len) {
-            free(outbuf);
+        if (out[n - 1 - i] != pad_len) {
             return -1;
         }
     }
     
-    *out = outbuf;
     *outn = n - pad_len;
     return 0;
 }
+
+int des_encrypt(const uint8_t *in, size_t n,
+                const uint8_t *key, size_t klen,
+                uint8_t **out, size_t *outn) {
+    if (!in || !key || !out || !outn) return -1;
+    
+    uint8_t *outbuf = malloc(des_encrypted_size(n));
+    if (!outbuf) return -1;
+    
+    if (des_encrypt_into(in, n, key, klen, outbuf, outn) != 0) {
+        free(outbuf);
+        return -1;
+    }
+    *out = outbuf;
+    return 0;
+}
+
+int des_decrypt(const uint8_t *in, size_t n,
+                const uint8_t *key, size_t klen,
+                uint8_t **out, size_t *outn) {
+    if (!in || !key || !out || !outn) return -1;
+    
+    uint8_t *outbuf = malloc(n ? n : 1);
+    if (!outbuf) return -1;
+    
+    if (des_decrypt_into(in, n, key, klen, outbuf, outn) != 0) {
+        free(outbuf);
+        return -1;
+    }
+    *out = outbuf;
+    return 0;
+}
@@ -1,6 +1,36 @@
 #include "vigenere.h"
 #include <stdlib.h>
 
+int vig_encrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out)
+{
+    if (!in || !out || !key || klen == 0){
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        // suma byte a byte, modulando a 256
+        out[i] = (uint8_t)((in[i] + key[i % klen]) & 0xFF);
+    }
+    return 0;
+}
+
+int vig_decrypt_into(const uint8_t *in, size_t n,
+                     const uint8_t *key, size_t klen,
+                     uint8_t *out)
+{
+    if (!in || !out || !key || klen == 0){
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++){
+        // resta byte a byte, modulando a 256
+        out[i] = (uint8_t)((in[i] - key[i % klen]) & 0xFF);
+    }
+    return 0;
+}
+
 int vig_encrypt(const uint8_t *in, size_t n,
                 const uint8_t *key, size_t klen,
                 uint8_t **out, size_t *outn)
@@ -9,13 +39,10 @@ int vig_encrypt(const uint8_t *in, size_t n,
         return -1;
     }
 
-    uint8_t *buf = malloc(n);
+    uint8_t *buf = malloc(n ? n : 1);
     if (!buf) return -1;
 
-    for (size_t i = 0; i < n; i++){
-        // suma byte a byte, modulando a 256
-        buf[i] = (uint8_t)((in[i] + key[i % klen]) & 0xFF);
-    }
+    vig_encrypt_into(in, n, key, klen, buf);
 
     *out = buf;
     *outn = n;
@@ -30,13 +57,10 @@ int vig_decrypt(const uint8_t *in, size_t n,
         return -1;
     }
 
-    uint8_t *buf = malloc(n);
+    uint8_t *buf = malloc(n ? n : 1);
     if (!buf) return -1;
 
-    for (size_t i = 0; i < n; i++){
-        // resta byte a byte, modulando a 256
-        buf[i] = (uint8_t)((in[i] - key[i % klen]) & 0xFF);
-    }
+    vig_decrypt_into(in, n, key, klen, buf);
 
     *out = buf;
     *outn = n;
@@ -0,0 +1,617 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "gsea.h"
+#include "dedup.h"
+#include "container.h"
+#include "stream.h"
+#include "walk.h"
+#include "sha256.h"
+#include "cpus.h"
+#include "pool.h"
+#include "log.h"
+
+#define RECIPE_HDR       20       // magic + [u64 tamaño] + [u32 chunks]
+#define DEDUP_AVG        (64u << 10)
+
+static void put_u32(uint8_t *p, uint32_t v){
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (24 - 8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v){
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint64_t get_u64(const uint8_t *p){
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = v << 8 | p[i];
+    return v;
+}
+
+// parámetros de FastCDC
+typedef struct {
+    size_t min, avg, max;
+    uint64_t mask_s;              // más exigente antes de avg ...
+    uint64_t mask_l;              // ... y más laxa después: tamaños más parejos
+} cdc_params_t;
+
+static uint64_t gear[256];
+static pthread_once_t gear_once = PTHREAD_ONCE_INIT;
+
+static void gear_init(void){
+    // tabla fija (splitmix64): los cortes no cambian entre corridas
+    uint64_t x = 0;
+    for (int i = 0; i < 256; i++){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        gear[i] = z ^ (z >> 31);
+    }
+}
+
+static void cdc_init(const gsea_opts_t *opt, cdc_params_t *p){
+    pthread_once(&gear_once, gear_init);
+    size_t want = opt->chunk_size ? opt->chunk_size : DEDUP_AVG;
+    int bits = 12;                // entre 4 KiB y 4 MiB
+    while (bits < 22 && ((size_t)1 << bits) < want) bits++;
+    p->avg = (size_t)1 << bits;
+    p->min = p->avg / 4;
+    p->max = p->avg * 4;
+    // bits altos del hash: son los que dependen de los últimos 64 bytes
+    p->mask_s = ~0ull << (64 - (bits + 2));
+    p->mask_l = ~0ull << (64 - (bits - 2));
+}
+
+// largo del próximo chunk de p[0..n); n < max solo al final del archivo
+static size_t cdc_cut(const cdc_params_t *c, const uint8_t *p, size_t n){
+    if (n <= c->min) return n;
+    size_t normal = n < c->avg ? n : c->avg;
+    size_t max = n < c->max ? n : c->max;
+    uint64_t h = 0;
+    size_t i = c->min;
+    for (; i < normal; i++){
+        h = (h << 1) + gear[p[i]];
+        if (!(h & c->mask_s)) return i + 1;
+    }
+    for (; i < max; i++){
+        h = (h << 1) + gear[p[i]];
+        if (!(h & c->mask_l)) return i + 1;
+    }
+    return max;
+}
+
+// reparte fn(ctx, i) para i en [0, n) entre hilos del pool compartido
+typedef struct {
+    int (*fn)(void *ctx, size_t i);
+    void *ctx;
+    size_t n;
+    size_t next;                  // próximo índice (atómico)
+} par_loop_t;
+
+static int par_worker(void *ptr){
+    par_loop_t *l = ptr;
+    int rc = 0;
+    for (;;){
+        size_t i = __atomic_fetch_add(&l->next, 1, __ATOMIC_RELAXED);
+        if (i >= l->n) break;
+        if (l->fn(l->ctx, i) != 0) rc = -1;
+    }
+    return rc;
+}
+
+static int par_for(const gsea_opts_t *opt, size_t n, int (*fn)(void *, size_t), void *ctx){
+    par_loop_t l = { fn, ctx, n, 0 };
+    size_t nthreads = (size_t)gsea_jobs(opt);
+    if (nthreads > n) nthreads = n;
+    gsea_pool_t *pool = gsea_pool_shared();
+    gsea_group_t g;
+    gsea_group_init(&g);
+    for (size_t i = 1; pool && i < nthreads; i++){
+        if (gsea_pool_submit(pool, &g, par_worker, &l) != 0) break;
+    }
+    int rc = par_worker(&l);
+    if (pool && gsea_pool_wait(pool, &g) != 0) rc = -1;
+    gsea_group_destroy(&g);
+    return rc;
+}
+
+typedef struct {
+    uint8_t  hash[GSEA_SHA256_LEN];
+    uint32_t len;
+} dd_chunk_t;
+
+typedef struct {
+    const gsea_file_job_t *job;
+    dd_chunk_t *chunks;
+    size_t n, cap;
+    uint32_t *ids;                // número de cada chunk en el almacén
+    uint64_t size;                // suma de los chunks
+} dd_file_t;
+
+// primera aparición de cada chunk distinto: de ahí se lee para el almacén
+typedef struct {
+    const uint8_t *hash;
+    size_t file;
+    uint64_t off;
+    uint32_t len;
+} dd_unique_t;
+
+typedef struct {
+    const gsea_opts_t *opt;
+    cdc_params_t cdc;
+    dd_file_t *files;
+    size_t nfiles;
+    dd_unique_t *uniq;
+    size_t nuniq;
+    uint64_t *starts;             // offset de cada chunk único en el almacén
+} dd_store_t;
+
+static int add_chunk(dd_file_t *f, const uint8_t *p, size_t len){
+    if (f->n == f->cap){
+        size_t ncap = f->cap ? f->cap * 2 : 16;
+        dd_chunk_t *nc = realloc(f->chunks, ncap * sizeof(*nc));
+        if (!nc) return -1;
+        f->chunks = nc;
+        f->cap = ncap;
+    }
+    dd_chunk_t *c = &f->chunks[f->n++];
+    gsea_sha256_t s;
+    gsea_sha256_init(&s);
+    gsea_sha256_update(&s, p, len);
+    gsea_sha256_final(&s, c->hash);
+    c->len = (uint32_t)len;
+    f->size += len;
+    return 0;
+}
+
+// corta un archivo en chunks leyéndolo en ventanas de hasta 2 * max bytes
+static int chunk_file(void *ctx, size_t i){
+    dd_store_t *d = ctx;
+    dd_file_t *f = &d->files[i];
+    const char *path = f->job->in_path;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        fprintf(stderr, "open '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t cap = f->job->size < 2 * d->cdc.max ? (size_t)f->job->size + 1 : 2 * d->cdc.max;
+    if (cap < d->cdc.max) cap = d->cdc.max;
+    uint8_t *buf = malloc(cap);
+    if (!buf){
+        perror("malloc chunks");
+        close(fd);
+        return -1;
+    }
+
+    int rc = 0, eof = 0;
+    size_t have = 0;
+    while (rc == 0){
+        while (!eof && have < cap){
+            ssize_t r = read(fd, buf + have, cap - have);
+            if (r < 0){
+                if (errno == EINTR) continue;
+                fprintf(stderr, "read '%s': %s\n", path, strerror(errno));
+                rc = -1;
+                break;
+            }
+            if (r == 0) eof = 1;
+            have += (size_t)r;
+        }
+        size_t pos = 0;
+        while (rc == 0 && (have - pos >= d->cdc.max || (eof && pos < have))){
+            size_t len = cdc_cut(&d->cdc, buf + pos, have - pos);
+            if (add_chunk(f, buf + pos, len) != 0){
+                perror("malloc chunks");
+                rc = -1;
+            }
+            pos += len;
+        }
+        if (eof) break;
+        memmove(buf, buf + pos, have - pos);
+        have -= pos;
+    }
+    free(buf);
+    close(fd);
+    return rc;
+}
+
+static int file_cmp(const void *a, const void *b){
+    return strcmp(((const dd_file_t *)a)->job->in_path, ((const dd_file_t *)b)->job->in_path);
+}
+
+static uint64_t hash_key(const uint8_t *h){
+    uint64_t k;
+    memcpy(&k, h, sizeof(k));
+    return k;
+}
+
+// numera los chunks distintos en orden de primera aparición
+static int dedup_ids(dd_store_t *d, uint64_t *total){
+    size_t nchunks = 0;
+    for (size_t i = 0; i < d->nfiles; i++) nchunks += d->files[i].n;
+    size_t tcap = 16;
+    while (tcap < nchunks * 2) tcap *= 2;
+    size_t *table = calloc(tcap, sizeof(*table));       // id + 1; 0 libre
+    d->uniq = malloc((nchunks ? nchunks : 1) * sizeof(*d->uniq));
+    if (!table || !d->uniq){
+        perror("malloc chunks");
+        free(table);
+        return -1;
+    }
+
+    *total = 0;
+    for (size_t i = 0; i < d->nfiles; i++){
+        dd_file_t *f = &d->files[i];
+        f->ids = malloc((f->n ? f->n : 1) * sizeof(*f->ids));
+        if (!f->ids){
+            perror("malloc chunks");
+            free(table);
+            return -1;
+        }
+        uint64_t off = 0;
+        for (size_t k = 0; k < f->n; k++){
+            const dd_chunk_t *c = &f->chunks[k];
+            size_t t = hash_key(c->hash) & (tcap - 1);
+            while (table[t] && memcmp(d->uniq[table[t] - 1].hash, c->hash, GSEA_SHA256_LEN) != 0){
+                t = (t + 1) & (tcap - 1);
+            }
+            if (!table[t]){
+                if (d->nuniq == UINT32_MAX){
+                    fprintf(stderr, "error: demasiados chunks distintos\n");
+                    free(table);
+                    return -1;
+                }
+                dd_unique_t *u = &d->uniq[d->nuniq++];
+                u->hash = c->hash;
+                u->file = i;
+                u->off = off;
+                u->len = c->len;
+                table[t] = d->nuniq;
+            }
+            f->ids[k] = (uint32_t)(table[t] - 1);
+            off += c->len;
+        }
+        *total += f->size;
+    }
+    free(table);
+    return 0;
+}
+
+// gsea_vsource_t del almacén: los chunks únicos uno detrás de otro
+static int store_read(void *ctx, uint8_t *buf, size_t n, uint64_t off){
+    const dd_store_t *d = ctx;
+    while (n > 0){
+        size_t lo = 0, hi = d->nuniq;
+        while (hi - lo > 1){
+            size_t mid = lo + (hi - lo) / 2;
+            if (d->starts[mid] <= off) lo = mid;
+            else hi = mid;
+        }
+        const dd_unique_t *u = &d->uniq[lo];
+        uint64_t in_chunk = off - d->starts[lo];
+        size_t take = u->len - in_chunk < n ? (size_t)(u->len - in_chunk) : n;
+        const char *path = d->files[u->file].job->in_path;
+        int fd = open(path, O_RDONLY);
+        if (fd < 0){
+            fprintf(stderr, "open '%s': %s\n", path, strerror(errno));
+            return -1;
+        }
+        int rc = gsea_pread_full(fd, buf, take, u->off + in_chunk);
+        close(fd);
+        if (rc != 0){
+            fprintf(stderr, "error: '%s' cambió de tamaño mientras se deduplicaba\n", path);
+            return -1;
+        }
+        buf += take;
+        off += take;
+        n -= take;
+    }
+    return 0;
+}
+
+static int write_recipe(void *ctx, size_t i){
+    const dd_store_t *d = ctx;
+    const dd_file_t *f = &d->files[i];
+    size_t len = RECIPE_HDR + f->n * 4;
+    uint8_t *r = malloc(len);
+    if (!r){
+        perror("malloc receta");
+        return -1;
+    }
+    memcpy(r, GSEA_DEDUP_MAGIC, GSEA_DEDUP_MAGIC_LEN);
+    put_u64(r + 8, f->size);
+    put_u32(r + 16, (uint32_t)f->n);
+    for (size_t k = 0; k < f->n; k++) put_u32(r + RECIPE_HDR + 4 * k, f->ids[k]);
+
+    const char *path = f->job->out_path;
+    int rc = -1;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0){
+        fprintf(stderr, "open '%s': %s\n", path, strerror(errno));
+    } else {
+        rc = gsea_write_full(fd, r, len);
+        if (close(fd) != 0) rc = -1;
+        if (rc != 0) fprintf(stderr, "write '%s': %s\n", path, strerror(errno));
+    }
+    free(r);
+    return rc;
+}
+
+static int dedup_store(const gsea_opts_t *opt){
+    for (int i = 0; i < opt->ops_count; i++){
+        if (opt->ops_order[i] == 'd' || opt->ops_order[i] == 'u'){
+            fprintf(stderr, "error: --dedup no mezcla -c/-e con -d/-u\n");
+            return -1;
+        }
+    }
+    if (fs_ensure_dir(opt->out_path) != 0) return -1;
+
+    gsea_walk_t walk;
+    if (gsea_walk(opt->in_path, opt->out_path, opt->recursive, &walk) != 0){
+        fprintf(stderr, "no se pudo recorrer '%s'\n", opt->in_path);
+        return -1;
+    }
+    if (walk.skipped_dirs > 0){
+        GSEA_LOG(GSEA_LOG_WARN, "dedup", "%zu subdirectorios omitidos (usar -r para incluirlos)",
+                 walk.skipped_dirs);
+    }
+
+    char store[4096];
+    int l = snprintf(store, sizeof(store), "%s/%s", opt->out_path, GSEA_DEDUP_STORE);
+    dd_store_t d;
+    memset(&d, 0, sizeof(d));
+    d.opt = opt;
+    cdc_init(opt, &d.cdc);
+    d.nfiles = walk.count;
+    d.files = calloc(d.nfiles ? d.nfiles : 1, sizeof(*d.files));
+    int rc = -1;
+    if (l < 0 || (size_t)l >= sizeof(store)){
+        fprintf(stderr, "error: ruta demasiado larga: '%s'\n", opt->out_path);
+        goto out;
+    }
+    if (!d.files){
+        perror("calloc archivos");
+        goto out;
+    }
+    for (size_t i = 0; i < d.nfiles; i++){
+        d.files[i].job = &walk.jobs[i];
+        if (strcmp(walk.jobs[i].out_path, store) == 0){
+            fprintf(stderr, "error: '%s' choca con el almacén de chunks\n", walk.jobs[i].in_path);
+            goto out;
+        }
+    }
+
+    // 1. cortar y hashear, un archivo por tarea
+    if (par_for(opt, d.nfiles, chunk_file, &d) != 0) goto out;
+
+    // 2. numerar los chunks distintos. Los archivos van ordenados por ruta
+    //    para que la salida no dependa del orden del recorrido
+    qsort(d.files, d.nfiles, sizeof(*d.files), file_cmp);
+    uint64_t total;
+    if (dedup_ids(&d, &total) != 0) goto out;
+
+    // 3. los chunks únicos pasan por la cadena como bloques de tamaño variable
+    d.starts = malloc((d.nuniq + 1) * sizeof(*d.starts));
+    if (!d.starts){
+        perror("malloc chunks");
+        goto out;
+    }
+    d.starts[0] = 0;
+    for (size_t u = 0; u < d.nuniq; u++) d.starts[u + 1] = d.starts[u] + d.uniq[u].len;
+    gsea_opts_t sopt = *opt;
+    sopt.out_path = store;
+    sopt.chunk_size = d.cdc.max;
+    gsea_vsource_t vs = { d.starts[d.nuniq], store_read, &d, d.starts, d.nuniq };
+    size_t nthreads = (size_t)gsea_jobs(opt);
+    gsea_blkjob_t *j = gsea_blkjob_open_virtual(&sopt, nthreads * 2, &vs, GSEA_HDR_DEDUP);
+    if (!j) goto out;
+    if (nthreads > d.nuniq) nthreads = d.nuniq ? d.nuniq : 1;
+    rc = gsea_blkjob_process(j, nthreads);
+    gsea_blkjob_free(j);
+
+    // 4. las recetas, recién con el almacén completo
+    if (rc == 0) rc = par_for(opt, d.nfiles, write_recipe, &d);
+    if (rc == 0){
+        size_t nchunks = 0;
+        for (size_t i = 0; i < d.nfiles; i++) nchunks += d.files[i].n;
+        GSEA_LOG(GSEA_LOG_INFO, "dedup",
+                 "archivos=%zu chunks=%zu únicos=%zu, %llu bytes -> %llu únicos (%.1f%%)",
+                 d.nfiles, nchunks, d.nuniq, (unsigned long long)total,
+                 (unsigned long long)d.starts[d.nuniq],
+                 total ? 100.0 * (double)d.starts[d.nuniq] / (double)total : 100.0);
+    }
+    if (walk.failed) rc = -1;
+out:
+    for (size_t i = 0; d.files && i < d.nfiles; i++){
+        free(d.files[i].chunks);
+        free(d.files[i].ids);
+    }
+    free(d.files);
+    free(d.uniq);
+    free(d.starts);
+    gsea_walk_free(&walk);
+    return rc;
+}
+
+typedef struct {
+    const gsea_opts_t *opt;
+    const gsea_file_job_t *jobs;
+    const char *store;            // ruta del almacén, que no es una receta
+    int fd;
+    gsea_plan_t plan;
+    gsea_sink_t check;            // solo para gsea_sink_check
+    gsea_index_t idx;
+} dd_restore_t;
+
+static int restore_file(void *ctx, size_t i){
+    const dd_restore_t *r = ctx;
+    const gsea_file_job_t *j = &r->jobs[i];
+    if (strcmp(j->in_path, r->store) == 0) return 0;
+
+    int in = open(j->in_path, O_RDONLY);
+    if (in < 0){
+        fprintf(stderr, "open '%s': %s\n", j->in_path, strerror(errno));
+        return -1;
+    }
+    uint8_t hdr[RECIPE_HDR];
+    uint8_t *ids = NULL;
+    size_t n = 0;
+    int rc = -1;
+    if (gsea_pread_full(in, hdr, RECIPE_HDR, 0) == 0 &&
+        memcmp(hdr, GSEA_DEDUP_MAGIC, GSEA_DEDUP_MAGIC_LEN) == 0){
+        n = get_u32(hdr + 16);
+        ids = malloc(n ? n * 4 : 1);
+        if (ids && (n == 0 || gsea_pread_full(in, ids, n * 4, RECIPE_HDR) == 0)) rc = 0;
+    }
+    close(in);
+    if (rc != 0){
+        fprintf(stderr, "error: '%s' no es una receta de --dedup\n", j->in_path);
+        free(ids);
+        return -1;
+    }
+
+    int out = open(j->out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0){
+        fprintf(stderr, "open '%s': %s\n", j->out_path, strerror(errno));
+        free(ids);
+        return -1;
+    }
+    uint64_t written = 0;
+    for (size_t k = 0; rc == 0 && k < n; k++){
+        uint32_t id = get_u32(ids + 4 * k);
+        if (id >= r->idx.n){
+            fprintf(stderr, "error: '%s' usa el chunk %u, el almacén tiene %zu\n",
+                    j->in_path, id, r->idx.n);
+            rc = -1;
+            break;
+        }
+        const gsea_block_t *b = &r->idx.v[id];
+        uint8_t *data = NULL, *res = NULL;
+        size_t reslen = 0;
+        gsea_blkinfo_t info;
+        if (gsea_frame_load(r->fd, &r->plan.in_hdr, b, &data, &info) != 0 ||
+            gsea_plan_apply(&r->plan, r->opt, info.raw_len, 0, r->plan.nsteps,
+                            data, b->stored_len, &res, &reslen) != 0 ||
+            gsea_sink_check(&r->check, res, reslen, &info) != 0){
+            rc = -1;
+        } else if (gsea_write_full(out, res, reslen) != 0){
+            fprintf(stderr, "write '%s': %s\n", j->out_path, strerror(errno));
+            rc = -1;
+        }
+        written += reslen;
+        free(data);
+        free(res);
+    }
+    if (close(out) != 0 && rc == 0){
+        fprintf(stderr, "close '%s': %s\n", j->out_path, strerror(errno));
+        rc = -1;
+    }
+    if (rc == 0 && written != get_u64(hdr + 8)){
+        fprintf(stderr, "error: '%s' reconstruido con %llu bytes, se esperaban %llu\n",
+                j->out_path, (unsigned long long)written,
+                (unsigned long long)get_u64(hdr + 8));
+        rc = -1;
+    }
+    free(ids);
+    return rc;
+}
+
+static int dedup_restore(const gsea_opts_t *opt){
+    char store[4096];
+    int l = snprintf(store, sizeof(store), "%s/%s", opt->in_path, GSEA_DEDUP_STORE);
+    if (l < 0 || (size_t)l >= sizeof(store)){
+        fprintf(stderr, "error: ruta demasiado larga: '%s'\n", opt->in_path);
+        return -1;
+    }
+
+    dd_restore_t r;
+    memset(&r, 0, sizeof(r));
+    r.opt = opt;
+    r.store = store;
+    r.fd = open(store, O_RDONLY);
+    if (r.fd < 0){
+        fprintf(stderr, "error: '%s' no tiene almacén de chunks (%s): %s\n",
+                opt->in_path, GSEA_DEDUP_STORE, strerror(errno));
+        return -1;
+    }
+    gsea_header_t hdr;
+    uint8_t pre[GSEA_HDR_FIXED];
+    size_t pre_len;
+    if (gsea_container_probe(r.fd, &hdr, pre, &pre_len) != 1 || !(hdr.flags & GSEA_HDR_DEDUP)){
+        fprintf(stderr, "error: '%s' no es un almacén de --dedup\n", store);
+        close(r.fd);
+        return -1;
+    }
+    size_t chunk = hdr.chunk_size ? hdr.chunk_size : GSEA_DEFAULT_CHUNK;
+    if (gsea_plan_build(opt, 1, &hdr, chunk, &r.plan) != 0){
+        close(r.fd);
+        return -1;
+    }
+    if (r.plan.framed_out){
+        fprintf(stderr, "error: --dedup requiere la cadena inversa completa\n");
+        close(r.fd);
+        return -1;
+    }
+    r.check.check_raw = 1;
+    r.check.check_crc = (hdr.flags & GSEA_HDR_RAW_CRC) != 0;
+    if (gsea_index_read(r.fd, gsea_header_size(&hdr), gsea_frame_hdr_size(hdr.version),
+                        &r.idx) != 0){
+        close(r.fd);
+        return -1;
+    }
+
+    int rc = -1;
+    gsea_walk_t walk;
+    if (fs_ensure_dir(opt->out_path) == 0 &&
+        gsea_walk(opt->in_path, opt->out_path, opt->recursive, &walk) == 0){
+        if (walk.skipped_dirs > 0){
+            GSEA_LOG(GSEA_LOG_WARN, "dedup", "%zu subdirectorios omitidos (usar -r para incluirlos)",
+                     walk.skipped_dirs);
+        }
+        r.jobs = walk.jobs;
+        // los chunks que comparten varios archivos se decodifican una vez por
+        // archivo: las recetas se reparten entre los hilos
+        rc = par_for(opt, walk.count, restore_file, &r);
+        if (rc == 0){
+            GSEA_LOG(GSEA_LOG_INFO, "dedup", "%zu archivos reconstruidos desde %zu chunks",
+                     walk.count > 0 ? walk.count - 1 : 0, r.idx.n);
+        }
+        if (walk.failed) rc = -1;
+        gsea_walk_free(&walk);
+    } else {
+        fprintf(stderr, "no se pudo recorrer '%s'\n", opt->in_path);
+    }
+    gsea_index_free(&r.idx);
+    close(r.fd);
+    return rc;
+}
+
+int gsea_dedup_detect(const char *dir){
+    char store[4096];
+    int l = snprintf(store, sizeof(store), "%s/%s", dir, GSEA_DEDUP_STORE);
+    if (l < 0 || (size_t)l >= sizeof(store)) return 0;
+    int fd = open(store, O_RDONLY);
+    if (fd < 0) return 0;
+    gsea_header_t hdr;
+    uint8_t pre[GSEA_HDR_FIXED];
+    size_t pre_len;
+    int framed = gsea_container_probe(fd, &hdr, pre, &pre_len);
+    close(fd);
+    return framed == 1 && (hdr.flags & GSEA_HDR_DEDUP);
+}
+
+int gsea_process_dedup(const gsea_opts_t *opt){
+    char first = opt->ops_count > 0 ? opt->ops_order[0] : 0;
+    if (first == 'c' || first == 'e') return dedup_store(opt);
+    return dedup_restore(opt);
+}
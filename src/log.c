@@ -0,0 +1,299 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "log.h"
+
+#define RING_SLOTS 256            // mensajes por hilo sin que el escritor los vacíe
+#define MSG_MAX    480            // lo que no entra se corta con "..."
+#define REC_OUT    (MSG_MAX * 6 + 128)   // peor caso de una línea JSON
+#define OUT_BUF    (1 << 16)
+#define FULL_TRIES 16             // cesiones al escritor antes de descartar un debug/trace
+
+typedef struct {
+    int64_t  ts_ns;               // CLOCK_REALTIME
+    uint16_t len;
+    uint8_t  level;
+    char     tag[13];
+    char     msg[MSG_MAX];
+} log_rec_t;
+
+// Anillo de un hilo: solo el dueño avanza 'tail' y solo el escritor 'head',
+// cada uno en su línea de caché
+typedef struct log_ring {
+    struct log_ring *next;        // la lista solo crece; los anillos se reusan
+    unsigned id;                  // número de hilo en los mensajes
+    int in_use;                   // lo tiene un hilo vivo (con reg_lock)
+    _Alignas(64) size_t head;
+    size_t limit;                 // tail visto al empezar la pasada del escritor
+    _Alignas(64) size_t tail;
+    log_rec_t slot[RING_SLOTS];
+} log_ring_t;
+
+int gsea_log_level = GSEA_LOG_INFO;
+static int log_json;
+static int log_ready;
+
+static pthread_key_t ring_key;
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+static int writer_ok;
+static pthread_mutex_t reg_lock = PTHREAD_MUTEX_INITIALIZER;
+static log_ring_t *rings;
+static unsigned nrings;
+
+static sem_t wake_sem;
+static int pending;               // hay un sem_post que el escritor no atendió
+static size_t dropped;
+
+// gsea_log_flush: el escritor publica hasta qué pedido vació todo
+static pthread_mutex_t flush_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t flush_req, flush_done;
+
+static const char *level_name[] = { "error", "warn", "info", "debug", "trace" };
+
+static void write_all(const char *buf, size_t n){
+    while (n > 0){
+        ssize_t w = write(STDERR_FILENO, buf, n);
+        if (w < 0){
+            if (errno == EINTR) continue;
+            return;
+        }
+        buf += w;
+        n -= (size_t)w;
+    }
+}
+
+// escribe la línea del mensaje en 'out' (al menos REC_OUT bytes)
+static size_t format_rec(const log_rec_t *rec, unsigned thread, char *out){
+    size_t n = 0;
+    if (!log_json){
+        if (rec->tag[0]) n = (size_t)snprintf(out, REC_OUT, "[%s] ", rec->tag);
+        memcpy(out + n, rec->msg, rec->len);
+        n += rec->len;
+        out[n++] = '\n';
+        return n;
+    }
+    n = (size_t)snprintf(out, REC_OUT, "{\"ts\":%lld.%06lld,\"level\":\"%s\",\"thread\":%u,",
+                         (long long)(rec->ts_ns / 1000000000),
+                         (long long)(rec->ts_ns % 1000000000 / 1000),
+                         level_name[rec->level], thread);
+    if (rec->tag[0]) n += (size_t)snprintf(out + n, REC_OUT - n, "\"tag\":\"%s\",", rec->tag);
+    memcpy(out + n, "\"msg\":\"", 7);
+    n += 7;
+    for (size_t i = 0; i < rec->len; i++){
+        unsigned char c = (unsigned char)rec->msg[i];
+        if (c == '"' || c == '\\'){
+            out[n++] = '\\';
+            out[n++] = (char)c;
+        } else if (c < 0x20){
+            n += (size_t)snprintf(out + n, 7, "\\u%04x", c);
+        } else {
+            out[n++] = (char)c;
+        }
+    }
+    memcpy(out + n, "\"}\n", 3);
+    return n + 3;
+}
+
+static void wake_writer(void){
+    // el load evita escribir la línea compartida mientras ya hay aviso
+    if (__atomic_load_n(&pending, __ATOMIC_SEQ_CST)) return;
+    if (!__atomic_exchange_n(&pending, 1, __ATOMIC_SEQ_CST)) sem_post(&wake_sem);
+}
+
+// vacía todos los anillos en orden de hora (mezcla de las cabezas)
+static void drain(char *out){
+    size_t n = 0;
+    log_ring_t *list = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+    for (log_ring_t *r = list; r; r = r->next){
+        r->limit = __atomic_load_n(&r->tail, __ATOMIC_SEQ_CST);
+    }
+    for (;;){
+        log_ring_t *best = NULL;
+        for (log_ring_t *r = list; r; r = r->next){
+            if (r->head == r->limit) continue;
+            if (!best || r->slot[r->head % RING_SLOTS].ts_ns <
+                         best->slot[best->head % RING_SLOTS].ts_ns){
+                best = r;
+            }
+        }
+        if (!best) break;
+        n += format_rec(&best->slot[best->head % RING_SLOTS], best->id, out + n);
+        __atomic_store_n(&best->head, best->head + 1, __ATOMIC_RELEASE);
+        if (OUT_BUF - n < REC_OUT){
+            write_all(out, n);
+            n = 0;
+        }
+    }
+    size_t lost = __atomic_exchange_n(&dropped, 0, __ATOMIC_RELAXED);
+    if (lost > 0 && gsea_log_level >= GSEA_LOG_WARN){
+        log_rec_t rec;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        rec.ts_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+        rec.level = GSEA_LOG_WARN;
+        strcpy(rec.tag, "log");
+        rec.len = (uint16_t)snprintf(rec.msg, sizeof(rec.msg),
+                                     "%zu mensajes descartados (anillo lleno)", lost);
+        pthread_mutex_lock(&reg_lock);
+        unsigned self = nrings;   // el escritor no tiene anillo
+        pthread_mutex_unlock(&reg_lock);
+        n += format_rec(&rec, self, out + n);
+    }
+    if (n > 0) write_all(out, n);
+}
+
+static void *writer_thread(void *unused){
+    (void)unused;
+    char *out = malloc(OUT_BUF);
+    for (;;){
+        while (sem_wait(&wake_sem) != 0 && errno == EINTR){}
+        __atomic_store_n(&pending, 0, __ATOMIC_SEQ_CST);
+        pthread_mutex_lock(&flush_lock);
+        uint64_t req = flush_req;
+        pthread_mutex_unlock(&flush_lock);
+
+        if (out){
+            drain(out);
+        } else {
+            // sin buffer: se descarta todo para no bloquear a los hilos
+            for (log_ring_t *r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next){
+                __atomic_store_n(&r->head, __atomic_load_n(&r->tail, __ATOMIC_SEQ_CST),
+                                 __ATOMIC_RELEASE);
+            }
+        }
+
+        pthread_mutex_lock(&flush_lock);
+        if (req > flush_done) flush_done = req;
+        pthread_cond_broadcast(&flush_cond);
+        pthread_mutex_unlock(&flush_lock);
+    }
+    return NULL;
+}
+
+// el hilo terminó: su anillo queda para otro (el escritor termina de vaciarlo)
+static void ring_release(void *ptr){
+    log_ring_t *r = ptr;
+    pthread_mutex_lock(&reg_lock);
+    r->in_use = 0;
+    pthread_mutex_unlock(&reg_lock);
+}
+
+static void log_start(void){
+    if (pthread_key_create(&ring_key, ring_release) != 0) return;
+    if (sem_init(&wake_sem, 0, 0) != 0) return;
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&tid, &attr, writer_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (err == 0) __atomic_store_n(&writer_ok, 1, __ATOMIC_RELEASE);
+}
+
+static log_ring_t *ring_get(void){
+    log_ring_t *r = pthread_getspecific(ring_key);
+    if (r) return r;
+    pthread_mutex_lock(&reg_lock);
+    for (r = rings; r; r = r->next){
+        if (!r->in_use) break;
+    }
+    if (!r){
+        r = aligned_alloc(_Alignof(log_ring_t), sizeof(*r));
+        if (r){
+            r->next = rings;
+            r->id = nrings++;
+            r->head = r->limit = r->tail = 0;
+            __atomic_store_n(&rings, r, __ATOMIC_RELEASE);
+        }
+    }
+    if (r) r->in_use = 1;
+    pthread_mutex_unlock(&reg_lock);
+    if (r) pthread_setspecific(ring_key, r);
+    return r;
+}
+
+static void log_atexit(void){
+    gsea_log_flush();
+}
+
+void gsea_log_init(int level, int json){
+    if (level < GSEA_LOG_ERROR) level = GSEA_LOG_ERROR;
+    if (level > GSEA_LOG_TRACE) level = GSEA_LOG_TRACE;
+    gsea_log_level = level;
+    log_json = json;
+    if (!log_ready){
+        log_ready = 1;
+        atexit(log_atexit);
+    }
+}
+
+void gsea_log_write(int level, const char *tag, const char *fmt, ...){
+    log_rec_t local, *rec = &local;
+    log_ring_t *r = NULL;
+    size_t tail = 0;
+    if (log_ready){
+        pthread_once(&log_once, log_start);
+        if (__atomic_load_n(&writer_ok, __ATOMIC_ACQUIRE)) r = ring_get();
+    }
+    if (r){
+        tail = r->tail;           // solo lo escribe este hilo
+        for (int tries = 0; tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) >= RING_SLOTS;
+             tries++){
+            if (level > GSEA_LOG_INFO && tries >= FULL_TRIES){
+                __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            wake_writer();
+            sched_yield();
+        }
+        rec = &r->slot[tail % RING_SLOTS];
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rec->ts_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    rec->level = (uint8_t)level;
+    snprintf(rec->tag, sizeof(rec->tag), "%s", tag ? tag : "");
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(rec->msg, sizeof(rec->msg), fmt, ap);
+    va_end(ap);
+    if (len < 0) len = 0;
+    if ((size_t)len >= sizeof(rec->msg)){
+        len = (int)sizeof(rec->msg) - 1;
+        memcpy(rec->msg + len - 3, "...", 3);
+    }
+    rec->len = (uint16_t)len;
+
+    if (r){
+        __atomic_store_n(&r->tail, tail + 1, __ATOMIC_SEQ_CST);
+        wake_writer();
+        return;
+    }
+    // sin escritor (antes de gsea_log_init o si no se pudo crear): directo
+    char out[REC_OUT];
+    write_all(out, format_rec(rec, 0, out));
+}
+
+void gsea_log_flush(void){
+    if (!__atomic_load_n(&writer_ok, __ATOMIC_ACQUIRE)) return;
+    pthread_mutex_lock(&flush_lock);
+    uint64_t req = ++flush_req;
+    pthread_mutex_unlock(&flush_lock);
+    // el escritor puede estar a mitad de una pasada que no incluye este pedido
+    __atomic_store_n(&pending, 1, __ATOMIC_SEQ_CST);
+    sem_post(&wake_sem);
+    pthread_mutex_lock(&flush_lock);
+    while (flush_done < req) pthread_cond_wait(&flush_cond, &flush_lock);
+    pthread_mutex_unlock(&flush_lock);
+}
@@ -2,21 +2,99 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <getopt.h>
 #include "gsea.h"
 #include "pipeline.h"
+#include "stream.h"
+#include "archive.h"
+#include "dedup.h"
+#include "log.h"
+#include "stats.h"
+
+// interpreta tamaños como "4096", "64K", "16M" o "1G"; -1 si no entra en size_t
+static int parse_size(const char *s, size_t *out){
+    char *end = NULL;
+    // strtoull acepta "-1" y lo da vuelta a ULLONG_MAX
+    if (*s < '0' || *s > '9') return -1;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (errno != 0 || end == s) return -1;
+    int shift = 0;
+    switch (*end){
+    case 'k': case 'K': shift = 10; end++; break;
+    case 'm': case 'M': shift = 20; end++; break;
+    case 'g': case 'G': shift = 30; end++; break;
+    default: break;
+    }
+    if (*end != '\0') return -1;
+    if (v > (ULLONG_MAX >> shift)) return -1;
+    v <<= shift;
+    if (v > SIZE_MAX) return -1;
+    *out = (size_t)v;
+    return 0;
+}
+
+// "off:len", "off:" (hasta el final) o "-off:len" (off contado desde el final)
+static int parse_range(const char *s, gsea_opts_t *opt){
+    char buf[64];
+    if (strlen(s) >= sizeof(buf)) return -1;
+    strcpy(buf, s);
+    char *colon = strchr(buf, ':');
+    if (colon) *colon = '\0';
+
+    char *off = buf;
+    opt->range_from_end = 0;
+    if (*off == '-'){
+        opt->range_from_end = 1;
+        off++;
+    }
+    size_t v;
+    if (parse_size(off, &v) != 0) return -1;
+    opt->range_off = v;
+
+    opt->range_len = UINT64_MAX;
+    if (colon && colon[1] != '\0'){
+        if (parse_size(colon + 1, &v) != 0) return -1;
+        opt->range_len = v;
+    }
+    opt->has_range = 1;
+    return 0;
+}
 
 static int parse_args(int argc, char **argv, gsea_opts_t *opt){
     memset(opt, 0, sizeof(*opt));
     static struct option longopts[] = {
         {"comp-alg", required_argument, 0, 1000},
         {"enc-alg",  required_argument, 0, 1001},
+        {"stream",     no_argument,       0, 1002},
+        {"chunk-size", required_argument, 0, 1003},
+        {"mmap",       no_argument,       0, 1004},
+        {"pipeline",   no_argument,       0, 1005},
+        {"blocks",     no_argument,       0, 1006},
+        {"range",      required_argument, 0, 1008},
+        {"block-size", required_argument, 0, 1007},
+        {"no-uring",   no_argument,       0, 1009},
+        {"verify",     no_argument,       0, 1010},
+        {"archive",    no_argument,       0, 1011},
+        {"member",     required_argument, 0, 1012},
+        {"list",       no_argument,       0, 1013},
+        {"manifest",   required_argument, 0, 1014},
+        {"dedup",      no_argument,       0, 1015},
+        {"log-json",   no_argument,       0, 1016},
+        {"stats",      optional_argument, 0, 1017},
+        {"mem-budget", required_argument, 0, 1018},
+        {"quiet",      no_argument,       0, 'q'},
+        {"verbose",    no_argument,       0, 'v'},
+        {"recursive",  no_argument,       0, 'r'},
+        {"jobs",       required_argument, 0, 'j'},
         {0,0,0,0}
     };
     int c;
-    while ((c = getopt_long(argc, argv, "cdeui:o:k:", longopts, NULL)) != -1){
+    while ((c = getopt_long(argc, argv, "cdeui:o:k:rj:qv", longopts, NULL)) != -1){
         switch(c){
         case 'c': opt->ops_order[opt->ops_count++] = 'c'; break;
         case 'd': opt->ops_order[opt->ops_count++] = 'd'; break;
@@ -25,16 +103,66 @@ static int parse_args(int argc, char **argv, gsea_opts_t *opt){
         case 'i': opt->in_path = optarg; break;
         case 'o': opt->out_path = optarg; break;
         case 'k': opt->key = optarg; break;
+        case 'r': opt->recursive = 1; break;
+        case 'q': opt->verbosity--; break;
+        case 'v': opt->verbosity++; break;
+        case 'j': {
+            char *end;
+            long n = strtol(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0' || n < 1 || n > 1024){
+                fprintf(stderr, "Error: --jobs inválido '%s'\n", optarg);
+                return -1;
+            }
+            opt->jobs = (int)n;
+            break;
+        }
         case 1000: opt->comp_alg = optarg; break;
         case 1001: opt->enc_alg  = optarg; break;
+        case 1002: opt->stream = 1; break;
+        case 1003:
+        case 1007:
+            if (parse_size(optarg, &opt->chunk_size) != 0 ||
+                opt->chunk_size == 0 || opt->chunk_size > GSEA_MAX_CHUNK){
+                fprintf(stderr, "Error: tamaño de bloque inválido '%s'\n", optarg);
+                return -1;
+            }
+            opt->stream = 1;
+            if (c == 1007) opt->parallel_blocks = 1;
+            break;
+        case 1004: opt->use_mmap = 1; break;
+        case 1005: opt->pipelined = 1; opt->stream = 1; break;
+        case 1006: opt->parallel_blocks = 1; opt->stream = 1; break;
+        case 1008:
+            if (parse_range(optarg, opt) != 0){
+                fprintf(stderr, "Error: --range inválido '%s' (use off:len)\n", optarg);
+                return -1;
+            }
+            break;
+        case 1009: opt->no_uring = 1; break;
+        case 1010: opt->verify = 1; break;
+        case 1011: opt->archive = 1; break;
+        case 1012: opt->member = optarg; break;
+        case 1013: opt->list = 1; break;
+        case 1014: opt->manifest = optarg; break;
+        case 1015: opt->dedup = 1; break;
+        case 1016: opt->log_json = 1; break;
+        case 1017: opt->stats = 1; opt->stats_path = optarg; break;
+        case 1018:
+            if (parse_size(optarg, &opt->mem_budget) != 0 || opt->mem_budget == 0){
+                fprintf(stderr, "Error: --mem-budget inválido '%s'\n", optarg);
+                return -1;
+            }
+            break;
         default:
             fprintf(stderr,
-              "Uso: %s -[c|d][e|u] -i in -o out [--comp-alg rle|lzw|huffman] [--enc-alg vigenere|des|aes] [-k clave]\n",
+              "Uso: %s -[c|d][e|u] -i in -o out [-r] [-j N] [-q|-v] [--comp-alg rle|lzw|huffman] [--enc-alg vigenere|des|aes] [-k clave] [--stream] [--chunk-size N] [--mmap] [--pipeline] [--blocks] [--block-size N] [--range off:len] [--no-uring] [--verify] [--archive] [--member NAME] [--list] [--manifest FILE] [--dedup] [--log-json] [--stats[=FILE]] [--mem-budget N]\n"
+              "       -i - / -o - usan stdin / stdout\n",
                argv[0]);
             return -1;
         }
     }
-    if (!opt->in_path || !opt->out_path){
+    // --verify y --list no escriben nada, así que -o no hace falta
+    if (!opt->in_path || (!opt->out_path && !opt->verify && !opt->list)){
         fprintf(stderr, "Error: faltan -i o -o\n");
         return -1;
     }
@@ -44,24 +172,69 @@ static int parse_args(int argc, char **argv, gsea_opts_t *opt){
 int main(int argc, char **argv){
     gsea_opts_t opt;
     if (parse_args(argc, argv, &opt) != 0) return 1;
+    gsea_log_init(GSEA_LOG_INFO + opt.verbosity, opt.log_json);
+    if (opt.stats) gsea_stats_init(opt.stats_path);
 
-    int isdir = fs_is_dir(opt.in_path);
+    // "-" es stdin: nunca un directorio
+    int isdir = gsea_is_stdio(opt.in_path) ? 0 : fs_is_dir(opt.in_path);
     if (isdir == -1){
         perror("stat in");
         return 1;
     }
+    if (isdir && !opt.archive && gsea_is_stdio(opt.out_path)){
+        fprintf(stderr, "error: un directorio no se puede escribir en stdout (-o -)\n");
+        return 1;
+    }
+    // -d/-u sobre una salida de --dedup: el almacén la delata y las recetas
+    // solo se reconstruyen con él
+    char first = opt.ops_count > 0 ? opt.ops_order[0] : 0;
+    if (isdir && !opt.dedup && !opt.archive && !opt.verify && !opt.has_range &&
+        (first == 'd' || first == 'u') && gsea_dedup_detect(opt.in_path)){
+        GSEA_LOG(GSEA_LOG_INFO, "dedup", "'%s' tiene %s: se reconstruye como --dedup",
+                 opt.in_path, GSEA_DEDUP_STORE);
+        opt.dedup = 1;
+    }
+    if (opt.manifest && (!isdir || opt.archive)){
+        fprintf(stderr, "error: --manifest es para procesar un directorio archivo por archivo\n");
+        return 1;
+    }
+    if (opt.dedup && (!isdir || opt.archive || opt.manifest)){
+        fprintf(stderr, "error: --dedup necesita un directorio de entrada y no se combina "
+                        "con --archive ni --manifest\n");
+        return 1;
+    }
+    if (opt.archive && !isdir){
+        fprintf(stderr, "error: --archive necesita un directorio de entrada\n");
+        return 1;
+    }
 
+    if (opt.dedup){
+        // Directorio a almacén de chunks más recetas, o de vuelta
+        if (gsea_process_dedup(&opt) != 0){
+            GSEA_LOG(GSEA_LOG_ERROR, NULL, "error en --dedup");
+            return 1;
+        }
+        return 0;
+    }
+    if (opt.archive){
+        // Directorio a un solo archivo sólido
+        if (gsea_archive_create(&opt) != 0){
+            GSEA_LOG(GSEA_LOG_ERROR, NULL, "error creando el archivo");
+            return 1;
+        }
+        return 0;
+    }
     if (!isdir){
         if (gsea_process_file(&opt) != 0){
-            fprintf(stderr, "error procesando archivo\n");
+            GSEA_LOG(GSEA_LOG_ERROR, NULL, "error procesando archivo");
             return 1;
         }
         return 0;
     } else {
         // Directorio: procesar concurrentemente cada archivo regular
-        printf("Directorio detectado: '%s'\n", opt.in_path);
+        GSEA_LOG(GSEA_LOG_INFO, NULL, "Directorio detectado: '%s'", opt.in_path);
         if (fs_process_dir_concurrent(&opt) != 0){
-            fprintf(stderr, "error procesando directorio\n");
+            GSEA_LOG(GSEA_LOG_ERROR, NULL, "error procesando directorio");
             return 1;
         }
     }
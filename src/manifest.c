@@ -0,0 +1,398 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include "manifest.h"
+#include "sha256.h"
+#include "cpus.h"
+#include "pool.h"
+#include "log.h"
+
+#define MANIFEST_MAGIC "gsea-manifest 1"
+#define KEY_SALT_LEN   16
+#define KEY_TAG_LEN    16              // bytes de PBKDF2 que se guardan
+#define KEY_KDF_ITERS  200000
+
+// ruta relativa a la raíz de entrada (mismo criterio que las rutas de walk)
+static const char *rel_path(const gsea_opts_t *opt, const char *in_path){
+    size_t l = strlen(opt->in_path);
+    return in_path + l + (l > 0 && opt->in_path[l - 1] != '/');
+}
+
+static int keyed_chain(const gsea_opts_t *opt){
+    for (int i = 0; i < opt->ops_count; i++){
+        if (opt->ops_order[i] == 'e' || opt->ops_order[i] == 'u') return opt->key != NULL;
+    }
+    return 0;
+}
+
+static void hex_encode(const uint8_t *p, size_t n, char *out){
+    for (size_t i = 0; i < n; i++) snprintf(out + 2 * i, 3, "%02x", p[i]);
+}
+
+static int hex_nibble(char c){
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static int hex_decode(const char *s, uint8_t *out, size_t n){
+    for (size_t i = 0; i < n; i++){
+        int hi = hex_nibble(s[2 * i]), lo = hex_nibble(s[2 * i + 1]);
+        if (hi < 0 || lo < 0) return -1;
+        out[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return 0;
+}
+
+// sal del manifiesto anterior ("key=<sal>:<marca>" en su cadena); 0 si no tiene
+static int old_salt(const char *chain, uint8_t salt[KEY_SALT_LEN]){
+    const char *k = strstr(chain, " key=");
+    if (!k || strlen(k + 5) < 2 * KEY_SALT_LEN + 1 || k[5 + 2 * KEY_SALT_LEN] != ':') return 0;
+    return hex_decode(k + 5, salt, KEY_SALT_LEN) == 0;
+}
+
+static int new_salt(uint8_t salt[KEY_SALT_LEN]){
+    FILE *f = fopen("/dev/urandom", "rb");
+    size_t got = f ? fread(salt, 1, KEY_SALT_LEN, f) : 0;
+    if (f) fclose(f);
+    if (got != KEY_SALT_LEN){
+        GSEA_LOG(GSEA_LOG_ERROR, "manifest", "no se pudo leer /dev/urandom");
+        return -1;
+    }
+    return 0;
+}
+
+// Marca de la clave si la cadena cifra o descifra, "-" si no: cambiar -k
+// invalida las salidas. Es PBKDF2 con una sal propia del manifiesto y muchas
+// iteraciones, así quien lea el manifiesto no puede probar claves rápido
+static void key_id(const gsea_opts_t *opt, const uint8_t salt[KEY_SALT_LEN],
+                   char *buf, size_t n){
+    if (!keyed_chain(opt) || n < 2 * (KEY_SALT_LEN + KEY_TAG_LEN) + 2){
+        snprintf(buf, n, "-");
+        return;
+    }
+    uint8_t tag[GSEA_SHA256_LEN];
+    gsea_pbkdf2_sha256(opt->key, strlen(opt->key), salt, KEY_SALT_LEN, KEY_KDF_ITERS, tag);
+    hex_encode(salt, KEY_SALT_LEN, buf);
+    buf[2 * KEY_SALT_LEN] = ':';
+    hex_encode(tag, KEY_TAG_LEN, buf + 2 * KEY_SALT_LEN + 1);
+}
+
+// identifica el formato de salida: si cambia, ninguna salida anterior sirve
+static void chain_id(const gsea_opts_t *opt, const uint8_t salt[KEY_SALT_LEN],
+                     char *buf, size_t n){
+    char key[2 * (KEY_SALT_LEN + KEY_TAG_LEN) + 2];
+    key_id(opt, salt, key, sizeof(key));
+    snprintf(buf, n, "ops=%.*s comp=%s enc=%s key=%s stream=%d chunk=%zu verify=%d",
+             opt->ops_count, opt->ops_order,
+             opt->comp_alg ? opt->comp_alg : "-", opt->enc_alg ? opt->enc_alg : "-",
+             key, opt->stream, opt->stream ? opt->chunk_size : 0, opt->verify);
+}
+
+static uint64_t path_hash(const char *s){
+    uint64_t h = 1469598103934665603ull;        // FNV-1a
+    for (; *s; s++) h = (h ^ (uint8_t)*s) * 1099511628211ull;
+    return h;
+}
+
+static gsea_manifest_entry_t *manifest_find(const gsea_manifest_t *m, const char *path){
+    if (m->tcap == 0) return NULL;
+    for (size_t i = path_hash(path) & (m->tcap - 1); m->table[i]; i = (i + 1) & (m->tcap - 1)){
+        gsea_manifest_entry_t *e = &m->v[m->table[i] - 1];
+        if (strcmp(e->path, path) == 0) return e;
+    }
+    return NULL;
+}
+
+// agrega una entrada (la ruta debe vivir tanto como el manifiesto)
+static gsea_manifest_entry_t *manifest_add(gsea_manifest_t *m, const char *path){
+    if (m->n == m->cap){
+        size_t ncap = m->cap ? m->cap * 2 : 256;
+        gsea_manifest_entry_t *nv = realloc(m->v, ncap * sizeof(*nv));
+        if (!nv) return NULL;
+        m->v = nv;
+        m->cap = ncap;
+    }
+    // tabla a menos de la mitad llena
+    if ((m->n + 1) * 2 > m->tcap){
+        size_t ncap = m->tcap ? m->tcap * 2 : 512;
+        size_t *nt = calloc(ncap, sizeof(*nt));
+        if (!nt) return NULL;
+        for (size_t k = 0; k < m->n; k++){
+            size_t i = path_hash(m->v[k].path) & (ncap - 1);
+            while (nt[i]) i = (i + 1) & (ncap - 1);
+            nt[i] = k + 1;
+        }
+        free(m->table);
+        m->table = nt;
+        m->tcap = ncap;
+    }
+    size_t i = path_hash(path) & (m->tcap - 1);
+    while (m->table[i]) i = (i + 1) & (m->tcap - 1);
+    m->table[i] = m->n + 1;
+
+    gsea_manifest_entry_t *e = &m->v[m->n++];
+    memset(e, 0, sizeof(*e));
+    e->path = path;
+    return e;
+}
+
+void gsea_manifest_free(gsea_manifest_t *m){
+    free(m->v);
+    free(m->table);
+    gsea_strarena_free(&m->strings);
+    memset(m, 0, sizeof(*m));
+}
+
+// Carga el manifiesto anterior; si no existe o es de otra cadena queda vacío.
+// 'chain' queda con la cadena de esta corrida, con la sal del anterior si la
+// tenía (así la marca de la clave se puede comparar) o con una nueva
+static int manifest_load(const gsea_opts_t *opt, gsea_manifest_t *m, char *chain, size_t n){
+    const char *path = opt->manifest;
+    uint8_t salt[KEY_SALT_LEN] = { 0 };
+    memset(m, 0, sizeof(*m));
+    FILE *f = fopen(path, "r");
+    if (!f){
+        if (errno != ENOENT){
+            GSEA_LOG(GSEA_LOG_ERROR, "manifest", "no se pudo abrir %s: %s", path, strerror(errno));
+            return -1;
+        }
+        if (keyed_chain(opt) && new_salt(salt) != 0) return -1;
+        chain_id(opt, salt, chain, n);
+        return 0;
+    }
+
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t len = getline(&line, &cap, f);
+    size_t lm = strlen(MANIFEST_MAGIC);
+    int is_manifest = len > 0 && strncmp(line, MANIFEST_MAGIC, lm) == 0 && line[lm] == '\t';
+    if (is_manifest && line[len - 1] == '\n') line[--len] = '\0';
+    if (keyed_chain(opt) && !(is_manifest && old_salt(line + lm + 1, salt)) &&
+        new_salt(salt) != 0){
+        free(line);
+        fclose(f);
+        return -1;
+    }
+    chain_id(opt, salt, chain, n);
+    if (!is_manifest){
+        GSEA_LOG(GSEA_LOG_WARN, "manifest", "%s no es un manifiesto, se procesa todo", path);
+        goto out;
+    }
+    if (strcmp(line + lm + 1, chain) != 0){
+        GSEA_LOG(GSEA_LOG_INFO, "manifest", "la cadena cambió (%s), se procesa todo", line + lm + 1);
+        goto out;
+    }
+
+    while ((len = getline(&line, &cap, f)) > 0){
+        if (line[len - 1] == '\n') line[--len] = '\0';
+        unsigned long long size, ino;
+        long long mtime;
+        uint8_t hash[GSEA_SHA256_LEN];
+        int pos = 0;
+        // línea dañada: ese archivo se procesa de nuevo
+        if (sscanf(line, "%llu %lld %llu %n", &size, &mtime, &ino, &pos) != 3 || pos == 0 ||
+            len < pos + 2 * GSEA_SHA256_LEN + 2 || line[pos + 2 * GSEA_SHA256_LEN] != ' ' ||
+            hex_decode(line + pos, hash, GSEA_SHA256_LEN) != 0){
+            continue;
+        }
+        const char *rel = line + pos + 2 * GSEA_SHA256_LEN + 1;
+        size_t lp = (size_t)(len - (rel - line));
+        char *p = gsea_strarena_alloc(&m->strings, lp + 1);
+        if (p) memcpy(p, rel, lp + 1);
+        gsea_manifest_entry_t *e = p ? manifest_add(m, p) : NULL;
+        if (!e){
+            perror("[manifest] malloc");
+            free(line);
+            fclose(f);
+            gsea_manifest_free(m);
+            return -1;
+        }
+        e->size = size;
+        e->mtime_ns = mtime;
+        e->ino = ino;
+        memcpy(e->hash, hash, GSEA_SHA256_LEN);
+    }
+out:
+    free(line);
+    fclose(f);
+    return 0;
+}
+
+// la salida de un archivo salteado tiene que seguir ahí
+static int output_present(const gsea_file_job_t *j){
+    struct stat st;
+    return !j->out_path || (stat(j->out_path, &st) == 0 && S_ISREG(st.st_mode));
+}
+
+static int same_meta(const gsea_manifest_entry_t *e, const gsea_file_job_t *j){
+    return e->size == j->size && e->mtime_ns == j->mtime_ns && e->ino == j->ino;
+}
+
+// archivos a hashear, repartidos entre tareas del pool
+typedef struct {
+    const gsea_file_job_t *jobs;
+    const size_t *idx;
+    uint8_t (*hash)[GSEA_SHA256_LEN];
+    int *hashed;
+    size_t n;
+    size_t next;                  // próximo a hashear (atómico)
+} hash_work_t;
+
+static int hash_worker(void *ptr){
+    hash_work_t *hw = ptr;
+    for (;;){
+        size_t k = __atomic_fetch_add(&hw->next, 1, __ATOMIC_RELAXED);
+        if (k >= hw->n) break;
+        // si no se puede leer se procesa igual y ahí se informa el error
+        hw->hashed[k] = gsea_sha256_file(hw->jobs[hw->idx[k]].in_path, hw->hash[k]) == 0;
+    }
+    return 0;
+}
+
+static void hash_all(const gsea_opts_t *opt, hash_work_t *hw){
+    size_t nthreads = (size_t)gsea_jobs(opt);
+    if (nthreads > hw->n) nthreads = hw->n;
+    gsea_pool_t *pool = gsea_pool_shared();
+    gsea_group_t g;
+    gsea_group_init(&g);
+    for (size_t i = 1; pool && i < nthreads; i++){
+        if (gsea_pool_submit(pool, &g, hash_worker, hw) != 0) break;
+    }
+    hash_worker(hw);
+    if (pool) gsea_pool_wait(pool, &g);
+    gsea_group_destroy(&g);
+}
+
+int gsea_manifest_filter(const gsea_opts_t *opt, gsea_walk_t *walk, gsea_manifest_t *next){
+    memset(next, 0, sizeof(*next));
+    gsea_manifest_t old;
+    if (manifest_load(opt, &old, next->chain, sizeof(next->chain)) != 0) return -1;
+
+    size_t n = walk->count;
+    size_t *idx = malloc((n ? n : 1) * sizeof(*idx));
+    uint8_t (*hash)[GSEA_SHA256_LEN] = malloc((n ? n : 1) * sizeof(*hash));
+    int *hashed = calloc(n ? n : 1, sizeof(*hashed));
+    char *skip = calloc(n ? n : 1, 1);
+    int rc = -1;
+    if (!idx || !hash || !hashed || !skip){
+        perror("[manifest] malloc");
+        goto out;
+    }
+
+    // 1. mismos metadatos y salida presente: sin leer el archivo
+    size_t nhash = 0, unchanged = 0;
+    for (size_t i = 0; i < n; i++){
+        const gsea_file_job_t *j = &walk->jobs[i];
+        const char *rel = rel_path(opt, j->in_path);
+        const gsea_manifest_entry_t *e = manifest_find(&old, rel);
+        gsea_manifest_entry_t *ne = manifest_add(next, rel);
+        if (!ne){
+            perror("[manifest] malloc");
+            goto out;
+        }
+        ne->size = j->size;
+        ne->mtime_ns = j->mtime_ns;
+        ne->ino = j->ino;
+        if (e && same_meta(e, j) && output_present(j)){
+            memcpy(ne->hash, e->hash, GSEA_SHA256_LEN);
+            ne->keep = 1;
+            skip[i] = 1;
+            unchanged++;
+        } else {
+            idx[nhash++] = i;
+        }
+    }
+
+    // 2. el resto se hashea en paralelo: el hash va al manifiesto nuevo y
+    //    permite saltear los que solo cambiaron de mtime o inodo
+    hash_work_t hw = { walk->jobs, idx, hash, hashed, nhash, 0 };
+    if (nhash > 0) hash_all(opt, &hw);
+    size_t same_content = 0;
+    for (size_t k = 0; k < nhash; k++){
+        const gsea_file_job_t *j = &walk->jobs[idx[k]];
+        const char *rel = rel_path(opt, j->in_path);
+        gsea_manifest_entry_t *ne = manifest_find(next, rel);
+        if (!hashed[k]) continue;
+        memcpy(ne->hash, hash[k], GSEA_SHA256_LEN);
+        const gsea_manifest_entry_t *e = manifest_find(&old, rel);
+        if (e && e->size == j->size && memcmp(e->hash, hash[k], GSEA_SHA256_LEN) == 0 &&
+            output_present(j)){
+            ne->keep = 1;
+            skip[idx[k]] = 1;
+            same_content++;
+        }
+    }
+
+    // 3. quedan en la lista solo los que hay que procesar
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++){
+        if (!skip[i]) walk->jobs[kept++] = walk->jobs[i];
+    }
+    walk->count = kept;
+    GSEA_LOG(GSEA_LOG_INFO, "manifest",
+             "%zu sin cambios, %zu con el mismo contenido, %zu a procesar "
+             "(%zu hasheados)", unchanged, same_content, kept, nhash);
+    rc = 0;
+out:
+    if (rc != 0) gsea_manifest_free(next);
+    gsea_manifest_free(&old);
+    free(idx);
+    free(hash);
+    free(hashed);
+    free(skip);
+    return rc;
+}
+
+int gsea_manifest_commit(const gsea_opts_t *opt, const gsea_walk_t *walk,
+                         gsea_manifest_t *next){
+    for (size_t i = 0; i < walk->count; i++){
+        const gsea_file_job_t *j = &walk->jobs[i];
+        gsea_manifest_entry_t *e = manifest_find(next, rel_path(opt, j->in_path));
+        if (e && j->ok) e->keep = 1;
+    }
+
+    // se escribe al lado y se renombra: un corte a mitad de camino deja el
+    // manifiesto anterior, nunca uno a medias
+    char tmp[4096];
+    int l = snprintf(tmp, sizeof(tmp), "%s.tmp", opt->manifest);
+    if (l < 0 || (size_t)l >= sizeof(tmp)){
+        GSEA_LOG(GSEA_LOG_ERROR, "manifest", "ruta demasiado larga: %s", opt->manifest);
+        return -1;
+    }
+    FILE *f = fopen(tmp, "w");
+    if (!f){
+        GSEA_LOG(GSEA_LOG_ERROR, "manifest", "no se pudo crear %s: %s", tmp, strerror(errno));
+        return -1;
+    }
+    fprintf(f, "%s\t%s\n", MANIFEST_MAGIC, next->chain);
+    size_t written = 0;
+    for (size_t i = 0; i < next->n; i++){
+        const gsea_manifest_entry_t *e = &next->v[i];
+        // una ruta con salto de línea no entra en el formato: se reprocesa
+        if (!e->keep || strchr(e->path, '\n')) continue;
+        fprintf(f, "%" PRIu64 " %" PRId64 " %" PRIu64 " ", e->size, e->mtime_ns, e->ino);
+        for (int k = 0; k < GSEA_SHA256_LEN; k++) fprintf(f, "%02x", e->hash[k]);
+        fprintf(f, " %s\n", e->path);
+        written++;
+    }
+    int werr = ferror(f);
+    if (fclose(f) != 0) werr = 1;
+    if (werr){
+        GSEA_LOG(GSEA_LOG_ERROR, "manifest", "error escribiendo %s", tmp);
+        remove(tmp);
+        return -1;
+    }
+    if (rename(tmp, opt->manifest) != 0){
+        GSEA_LOG(GSEA_LOG_ERROR, "manifest", "no se pudo reemplazar %s: %s",
+                 opt->manifest, strerror(errno));
+        remove(tmp);
+        return -1;
+    }
+    GSEA_LOG(GSEA_LOG_INFO, "manifest", "%zu archivos en %s", written, opt->manifest);
+    return 0;
+}
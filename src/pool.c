@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "pool.h"
+#include "cpus.h"
+#include "log.h"
+#include "stats.h"
+
+typedef struct task {
+    struct task *next;
+    gsea_task_fn fn;
+    void *arg;
+    gsea_group_t *g;
+    int64_t queued;               // con --stats: cuándo se encoló
+} task_t;
+
+typedef struct {
+    task_t *head, *tail;
+    size_t n;
+} task_list_t;
+
+struct gsea_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t  work;         // hay tareas o hay que terminar
+    task_list_t urgent;           // gsea_pool_spawn: cada una tiene un hilo libre
+    task_list_t normal;
+    size_t idle;                  // hilos sin tarea; toman primero las urgentes
+    pthread_t *tids;
+    size_t nthreads, cap;
+    int stop;
+};
+
+static void list_push(task_list_t *l, task_t *t){
+    t->next = NULL;
+    if (l->tail) l->tail->next = t;
+    else l->head = t;
+    l->tail = t;
+    l->n++;
+}
+
+static task_t *list_pop(task_list_t *l){
+    task_t *t = l->head;
+    if (!t) return NULL;
+    l->head = t->next;
+    if (!l->head) l->tail = NULL;
+    l->n--;
+    return t;
+}
+
+// primera tarea del grupo g en la lista, o NULL
+static task_t *list_take_group(task_list_t *l, const gsea_group_t *g){
+    task_t *prev = NULL;
+    for (task_t *t = l->head; t; prev = t, t = t->next){
+        if (t->g != g) continue;
+        if (prev) prev->next = t->next;
+        else l->head = t->next;
+        if (l->tail == t) l->tail = prev;
+        l->n--;
+        return t;
+    }
+    return NULL;
+}
+
+// corre la tarea sin el lock; vuelve con el lock tomado
+static void task_run(gsea_pool_t *p, task_t *t){
+    pthread_mutex_unlock(&p->lock);
+    int64_t start = gsea_stats_on ? gsea_stats_now() : 0;
+    int rc = t->fn(t->arg);
+    if (gsea_stats_on) gsea_stats_task(start - t->queued, gsea_stats_now() - start);
+    pthread_mutex_lock(&p->lock);
+    gsea_group_t *g = t->g;
+    if (rc != 0) g->failed = 1;
+    if (--g->pending == 0) pthread_cond_broadcast(&g->done);
+    free(t);
+}
+
+static void *pool_thread(void *ptr){
+    gsea_pool_t *p = ptr;
+    pthread_mutex_lock(&p->lock);
+    for (;;){
+        task_t *t = list_pop(&p->urgent);
+        if (!t) t = list_pop(&p->normal);
+        if (!t){
+            if (p->stop) break;
+            pthread_cond_wait(&p->work, &p->lock);
+            continue;
+        }
+        p->idle--;
+        task_run(p, t);
+        p->idle++;
+    }
+    p->idle--;
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+// con el lock tomado; el hilo nuevo cuenta como libre desde ya
+static int add_thread(gsea_pool_t *p){
+    if (p->nthreads == p->cap){
+        size_t ncap = p->cap ? p->cap * 2 : 8;
+        pthread_t *nt = realloc(p->tids, ncap * sizeof(*nt));
+        if (!nt) return -1;
+        p->tids = nt;
+        p->cap = ncap;
+    }
+    int err = pthread_create(&p->tids[p->nthreads], NULL, pool_thread, p);
+    if (err != 0){
+        GSEA_LOG(GSEA_LOG_ERROR, "pool", "pthread_create fallo: %s", strerror(err));
+        return -1;
+    }
+    p->nthreads++;
+    p->idle++;
+    if (gsea_stats_on) gsea_stats_thread_added();
+    return 0;
+}
+
+void gsea_group_init(gsea_group_t *g){
+    g->pending = 0;
+    g->failed = 0;
+    pthread_cond_init(&g->done, NULL);
+}
+
+void gsea_group_destroy(gsea_group_t *g){
+    pthread_cond_destroy(&g->done);
+}
+
+gsea_pool_t *gsea_pool_create(size_t nthreads){
+    gsea_pool_t *p = calloc(1, sizeof(*p));
+    if (!p){
+        perror("calloc pool");
+        return NULL;
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->work, NULL);
+    if (nthreads == 0) nthreads = (size_t)gsea_cpu_count();
+
+    pthread_mutex_lock(&p->lock);
+    for (size_t i = 0; i < nthreads; i++){
+        if (add_thread(p) != 0) break;
+    }
+    size_t n = p->nthreads;
+    pthread_mutex_unlock(&p->lock);
+    if (n == 0){
+        gsea_pool_destroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+void gsea_pool_destroy(gsea_pool_t *p){
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->lock);
+
+    // los hilos vacían las colas antes de salir; nthreads ya no cambia
+    for (size_t i = 0; i < p->nthreads; i++) pthread_join(p->tids[i], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->work);
+    free(p->tids);
+    free(p);
+}
+
+static gsea_pool_t *shared_pool;
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+
+static void shared_init(void){
+    shared_pool = gsea_pool_create(0);
+}
+
+gsea_pool_t *gsea_pool_shared(void){
+    pthread_once(&shared_once, shared_init);
+    return shared_pool;
+}
+
+size_t gsea_pool_threads(gsea_pool_t *p){
+    pthread_mutex_lock(&p->lock);
+    size_t n = p->nthreads;
+    pthread_mutex_unlock(&p->lock);
+    return n;
+}
+
+static task_t *task_new(gsea_group_t *g, gsea_task_fn fn, void *arg){
+    task_t *t = malloc(sizeof(*t));
+    if (!t){
+        perror("malloc tarea");
+        return NULL;
+    }
+    t->fn = fn;
+    t->arg = arg;
+    t->g = g;
+    t->queued = gsea_stats_on ? gsea_stats_now() : 0;
+    return t;
+}
+
+int gsea_pool_submit(gsea_pool_t *p, gsea_group_t *g, gsea_task_fn fn, void *arg){
+    task_t *t = task_new(g, fn, arg);
+    if (!t) return -1;
+    pthread_mutex_lock(&p->lock);
+    list_push(&p->normal, t);
+    g->pending++;
+    pthread_cond_signal(&p->work);
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+int gsea_pool_spawn(gsea_pool_t *p, gsea_group_t *g, gsea_task_fn fn, void *arg){
+    task_t *t = task_new(g, fn, arg);
+    if (!t) return -1;
+    pthread_mutex_lock(&p->lock);
+    // cada urgente pendiente tiene reservado un hilo libre: los libres toman
+    // las urgentes antes que el resto, así ninguna queda esperando
+    if (p->idle < p->urgent.n + 1 && add_thread(p) != 0){
+        pthread_mutex_unlock(&p->lock);
+        free(t);
+        return -1;
+    }
+    list_push(&p->urgent, t);
+    g->pending++;
+    pthread_cond_signal(&p->work);
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+int gsea_pool_wait(gsea_pool_t *p, gsea_group_t *g){
+    pthread_mutex_lock(&p->lock);
+    while (g->pending > 0){
+        // solo tareas de este grupo: una ajena podría tardar mucho más que
+        // lo que falta del grupo, o esperar a algo que depende de él
+        task_t *t = list_take_group(&p->normal, g);
+        if (!t) t = list_take_group(&p->urgent, g);
+        if (t){
+            task_run(p, t);
+            continue;
+        }
+        pthread_cond_wait(&g->done, &p->lock);
+    }
+    int rc = g->failed ? -1 : 0;
+    pthread_mutex_unlock(&p->lock);
+    return rc;
+}
@@ -1,21 +1,432 @@
+#define _POSIX_C_SOURCE 200809L
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
 #include "gsea.h"
-#include "pipeline.h"              
-#include "rle.h"
-#include "lzw.h"
-#include "huffman.h"
-#include "vigenere.h"
-#include "des.h"
-#include "aes.h"
+#include "pipeline.h"
+#include "stream.h"
+#include "container.h"
+#include "codec.h"
+#include "archive.h"
+#include "dedup.h"
+#include "stats.h"
+#include "budget.h"
+
+static const char *step_verb(char op){
+    switch (op){
+    case 'c': return "compress";
+    case 'd': return "decompress";
+    case 'e': return "encrypt";
+    default:  return "decrypt";
+    }
+}
+
+// codec del paso, verificando que haya clave si la necesita
+static const gsea_codec_t *step_codec(const gsea_step_t *st, const char *key){
+    const gsea_codec_t *c = gsea_codec_by_id(st->alg);
+    if (!c){
+        fprintf(stderr, "error: algoritmo %u desconocido\n", st->alg);
+        return NULL;
+    }
+    if ((c->flags & GSEA_CODEC_NEEDS_KEY) && !key){
+        fprintf(stderr, "error: se pidió -%c pero no se pasó -k clave\n", st->op);
+        return NULL;
+    }
+    return c;
+}
+
+// tamaño de la salida del paso antes de ejecutarlo (ver gsea_codec_t)
+static int step_bound(const gsea_codec_t *c, char op,
+                      const uint8_t *in, size_t n, size_t *size){
+    gsea_codec_bound_fn fn = gsea_step_inverse(op) ? c->inverse_bound : c->forward_bound;
+    if (fn(in, n, size) != 0){
+        fprintf(stderr, "error: fallo %s %s\n", c->name, step_verb(op));
+        return -1;
+    }
+    return 0;
+}
+
+static int step_run(const gsea_codec_t *c, char op, const char *key,
+                    const uint8_t *in, size_t n, uint8_t *dst, size_t *dstlen){
+    gsea_codec_fn fn = gsea_step_inverse(op) ? c->inverse : c->forward;
+    size_t klen = key ? strlen(key) : 0;
+    int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+    if (fn(in, n, (const uint8_t*)key, klen, dst, dstlen) != 0){
+        fprintf(stderr, "error: fallo %s %s\n", c->name, step_verb(op));
+        return -1;
+    }
+    if (gsea_stats_on) gsea_stats_stage(c->name, step_verb(op), n, *dstlen, gsea_stats_now() - t0);
+    return 0;
+}
+
+int gsea_steps_from_opts(const gsea_opts_t *opt, gsea_step_t *steps){
+    for (int i = 0; i < opt->ops_count; i++){
+        const gsea_codec_t *c = gsea_codec_for_op(opt, opt->ops_order[i]);
+        if (!c) return -1;
+        steps[i].op = opt->ops_order[i];
+        steps[i].alg = c->id;
+    }
+    return opt->ops_count;
+}
+
+// buffer del worker que contiene 'p', o NULL si no es suyo
+static gsea_buf_t *worker_buf(gsea_worker_t *w, const uint8_t *p){
+    if (p && p == w->in.data) return &w->in;
+    if (p && p == w->stage[0].data) return &w->stage[0];
+    if (p && p == w->stage[1].data) return &w->stage[1];
+    return NULL;
+}
+
+int gsea_apply_steps_ws(const gsea_step_t *steps, int nsteps, const char *key,
+                        const size_t *limit, gsea_worker_t *w,
+                        const uint8_t *in, size_t n,
+                        const uint8_t **out, size_t *outn){
+    const uint8_t *cur = in;
+    size_t curlen = n;
+
+    for (int i = 0; i < nsteps; i++){
+        char op = steps[i].op;
+        const gsea_codec_t *c = step_codec(&steps[i], key);
+        if (!c) return -1;
+        size_t bound;
+        if (step_bound(c, op, cur, curlen, &bound) != 0) return -1;
+        // la cota de una descompresión sale de los datos: si promete más de
+        // lo que el bloque puede medir, los datos están dañados y no se reserva
+        if (limit && bound > curlen && bound > limit[i]){
+            fprintf(stderr, "error: bloque corrupto (%s %s de %zu bytes, el máximo es %zu)\n",
+                    c->name, step_verb(op), bound, limit[i]);
+            return -1;
+        }
+
+        // los cifrados trabajan en el lugar si el buffer actual es del worker
+        // y tiene lugar para el padding; si no, van al otro buffer del par
+        gsea_buf_t *own = worker_buf(w, cur);
+        gsea_buf_t *dst;
+        if ((c->flags & GSEA_CODEC_INPLACE) && own && own->cap >= bound){
+            dst = own;
+        } else {
+            dst = own == &w->stage[0] ? &w->stage[1] : &w->stage[0];
+            if (gsea_worker_reserve(w, dst, bound) != 0){
+                perror("malloc");
+                return -1;
+            }
+        }
+
+        size_t dstlen = 0;
+        if (step_run(c, op, key, cur, curlen, dst->data, &dstlen) != 0) return -1;
+        cur = dst->data;
+        curlen = dstlen;
+    }
+
+    *out = cur;
+    *outn = curlen;
+    return 0;
+}
+
+int gsea_apply_ops_ws(const gsea_opts_t *opt, gsea_worker_t *w,
+                      const uint8_t *in, size_t n,
+                      const uint8_t **out, size_t *outn){
+    gsea_step_t steps[sizeof(opt->ops_order)];
+    int nsteps = gsea_steps_from_opts(opt, steps);
+    if (nsteps < 0) return -1;
+    return gsea_apply_steps_ws(steps, nsteps, opt->key, NULL, w, in, n, out, outn);
+}
+
+void gsea_worker_free(gsea_worker_t *w){
+    gsea_buf_free(&w->in);
+    gsea_buf_free(&w->stage[0]);
+    gsea_buf_free(&w->stage[1]);
+}
+
+int gsea_worker_reserve(gsea_worker_t *w, gsea_buf_t *b, size_t n){
+    if (gsea_buf_reserve(b, n) != 0) return -1;
+    if (w->budget){
+        uint64_t held = (uint64_t)w->in.cap + w->stage[0].cap + w->stage[1].cap;
+        if (held > w->charged){
+            gsea_budget_charge(w->budget, held - w->charged);
+            w->charged = held;
+        }
+    }
+    return 0;
+}
+
+int gsea_apply_steps(const gsea_step_t *steps, int nsteps, const char *key,
+                     const size_t *limit, const uint8_t *in, size_t n,
+                     uint8_t **out, size_t *outn){
+    gsea_worker_t w;
+    memset(&w, 0, sizeof(w));
+
+    const uint8_t *res;
+    size_t reslen;
+    if (gsea_apply_steps_ws(steps, nsteps, key, limit, &w, in, n, &res, &reslen) != 0){
+        gsea_worker_free(&w);
+        return -1;
+    }
+
+    uint8_t *cur;
+    gsea_buf_t *b = worker_buf(&w, res);
+    if (!b){
+        // si ninguna operación produjo buffer propio devolvemos una copia
+        cur = malloc(reslen ? reslen : 1);
+        if (!cur){
+            perror("malloc");
+            gsea_worker_free(&w);
+            return -1;
+        }
+        memcpy(cur, in, reslen);
+    } else {
+        // el buffer final pasa al llamador; se recorta si la cota sobró
+        cur = b->data;
+        b->data = NULL;
+        if (reslen < b->cap){
+            uint8_t *shrunk = realloc(cur, reslen ? reslen : 1);
+            if (shrunk) cur = shrunk;
+        }
+    }
+    gsea_worker_free(&w);
+    *out = cur;
+    *outn = reslen;
+    return 0;
+}
+
+int gsea_apply_ops(const gsea_opts_t *opt, const uint8_t *in, size_t n,
+                   uint8_t **out, size_t *outn){
+    gsea_step_t steps[sizeof(opt->ops_order)];
+    int nsteps = gsea_steps_from_opts(opt, steps);
+    if (nsteps < 0) return -1;
+    return gsea_apply_steps(steps, nsteps, opt->key, NULL, in, n, out, outn);
+}
+
+/*
+ * Variante --mmap: la entrada se mapea en solo lectura y se pasa directo a la
+ * primera etapa; el archivo de salida se dimensiona con ftruncate según la
+ * cota de la última etapa y se mapea para que esa etapa escriba directamente
+ * en el page cache (al final se recorta al tamaño real).
+ */
+static int process_file_mmap(const gsea_opts_t *opt, gsea_worker_t *w){
+    int fd = open(opt->in_path, O_RDONLY);
+    if (fd < 0){
+        perror("open in");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1){
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+
+    size_t inlen = st.st_size;
+    uint8_t *map = NULL;
+    if (inlen > 0){
+        map = mmap(NULL, inlen, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED){
+            perror("mmap in");
+            close(fd);
+            return -1;
+        }
+        posix_madvise(map, inlen, POSIX_MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    static const uint8_t empty[1];
+    const uint8_t *cur = map ? map : empty;
+    size_t curlen = inlen;
+    int rc = 0;
+
+    gsea_step_t steps[sizeof(opt->ops_order)];
+    int nsteps = gsea_steps_from_opts(opt, steps);
+    if (nsteps <= 0){
+        if (map) munmap(map, inlen);
+        return -1;
+    }
+
+    // etapas previas a la última sobre los buffers del worker
+    int head = nsteps - 1;
+    if (head > 0){
+        int ar = gsea_apply_steps_ws(steps, head, opt->key, NULL, w, cur, curlen, &cur, &curlen);
+        if (map) munmap(map, inlen);
+        map = NULL;
+        if (ar != 0) return -1;
+    }
+
+    const gsea_step_t *last = &steps[head];
+    const gsea_codec_t *codec = step_codec(last, opt->key);
+    size_t outsize;
+    if (!codec || step_bound(codec, last->op, cur, curlen, &outsize) != 0){
+        rc = -1;
+        goto out;
+    }
+
+    int fd_out = open(opt->out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_out < 0){
+        perror("open out");
+        rc = -1;
+        goto out;
+    }
+    uint8_t dummy[1];
+    uint8_t *dst = dummy;
+    if (outsize > 0){
+        if (ftruncate(fd_out, (off_t)outsize) != 0){
+            perror("ftruncate");
+            close(fd_out);
+            rc = -1;
+            goto out;
+        }
+        dst = mmap(NULL, outsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd_out, 0);
+        if (dst == MAP_FAILED){
+            perror("mmap out");
+            close(fd_out);
+            rc = -1;
+            goto out;
+        }
+    }
+
+    size_t dstlen = 0;
+    if (step_run(codec, last->op, opt->key, cur, curlen, dst, &dstlen) != 0){
+        rc = -1;
+    }
+    if (dst != dummy) munmap(dst, outsize);
+    // compresión y descifrado: el tamaño real se conoce recién al terminar
+    size_t final_len = rc == 0 ? dstlen : 0;
+    if (final_len != outsize && ftruncate(fd_out, (off_t)final_len) != 0){
+        perror("ftruncate");
+        rc = -1;
+    }
+    if (close(fd_out) != 0 && rc == 0){
+        perror("close out");
+        rc = -1;
+    }
+
+out:
+    if (map) munmap(map, inlen);
+    return rc;
+}
 
 int gsea_process_file(const gsea_opts_t *opt){
-    // 1. leer archivo completo de entradaf
+    // --mem-budget: un archivo que no entra entero pasa a modo stream
+    gsea_opts_t fopt = *opt;
+    struct stat st;
+    gsea_budget_t budget;
+    gsea_input_t in = { 0 };
+    if (opt->mem_budget && opt->ops_count > 0 && !opt->has_range &&
+        !gsea_file_uses_blocks(opt, &in) && !gsea_is_stdio(opt->out_path) &&
+        !gsea_is_stdio(opt->in_path) && stat(opt->in_path, &st) == 0 &&
+        gsea_budget_init(&budget, opt, 1) == 0){
+        gsea_budget_fit(&budget, &fopt, (uint64_t)st.st_size);
+        gsea_budget_destroy(&budget);
+    }
+
+    gsea_worker_t w;
+    memset(&w, 0, sizeof(w));
+    int rc = gsea_process_file_ws(&fopt, &w, &in);
+    gsea_worker_free(&w);
+    return rc;
+}
+
+void gsea_input_probe(const gsea_opts_t *opt, gsea_input_t *in){
+    if (in->probed) return;
+    in->probed = 1;
+    in->framed = 0;
+    char first = opt->ops_count > 0 ? opt->ops_order[0] : 0;
+    if (gsea_is_stdio(opt->in_path)) return;
+    if (first != 'd' && first != 'u' && !opt->member && !opt->list) return;
+    int fd = open(opt->in_path, O_RDONLY);
+    if (fd < 0) return;           // el error lo da quien lo abra para procesarlo
+    uint8_t pre[GSEA_HDR_FIXED];
+    size_t pre_len;
+    in->framed = gsea_container_probe(fd, &in->hdr, pre, &pre_len);
+    // una receta de --dedup sin su almacén daría basura
+    uint8_t magic[GSEA_DEDUP_MAGIC_LEN];
+    if (in->framed == 0 && gsea_pread_full(fd, magic, sizeof(magic), 0) == 0 &&
+        memcmp(magic, GSEA_DEDUP_MAGIC, GSEA_DEDUP_MAGIC_LEN) == 0){
+        fprintf(stderr, "error: '%s' es una receta de --dedup: decodificar su directorio "
+                "con --dedup\n", opt->in_path);
+        in->framed = -1;
+    }
+    close(fd);
+}
+
+int gsea_file_uses_blocks(const gsea_opts_t *opt, gsea_input_t *in){
+    // mismo orden de decisión que gsea_process_file_ws
+    if (opt->has_range) return 0;
+    if (opt->verify) return 1;
+    if (gsea_is_stdio(opt->in_path) || gsea_is_stdio(opt->out_path)) return 0;
+    if (opt->ops_count == 0) return 0;
+    // --stream, --pipeline y --blocks escriben el mismo contenedor
+    if (opt->stream) return 1;
+    char first = opt->ops_order[0];
+    if (first != 'd' && first != 'u') return 0;
+    // un archivo de --archive se extrae a un directorio, no como un archivo
+    gsea_input_probe(opt, in);
+    return in->framed == 1 && !(in->hdr.flags & GSEA_HDR_ARCHIVE);
+}
+
+int gsea_process_file_ws(const gsea_opts_t *opt, gsea_worker_t *w, gsea_input_t *in){
+    if (opt->has_range){
+        if (gsea_is_stdio(opt->in_path)){
+            fprintf(stderr, "error: --range necesita un archivo de entrada, no stdin\n");
+            return -1;
+        }
+        return gsea_process_range(opt);
+    }
+
+    // --verify: deshace la cadena completa comprobando los CRC de cada bloque
+    // y descarta el resultado; con la tabla de bloques corre en todos los cores
+    if (opt->verify){
+        return gsea_process_blocks(opt, NULL);
+    }
+
+    // el header de la entrada se lee una vez y sirve para todo lo que sigue
+    gsea_input_t local = { 0 };
+    if (!in) in = &local;
+    if ((opt->member || opt->list) && gsea_is_stdio(opt->in_path)){
+        fprintf(stderr, "error: --member/--list necesitan un archivo de entrada, no stdin\n");
+        return -1;
+    }
+    gsea_input_probe(opt, in);
+    if (in->framed < 0) return -1;
+
+    // archivo de --archive: deshecha la cadena entera se extraen los miembros
+    char first = opt->ops_count > 0 ? opt->ops_order[0] : 0;
+    if (opt->member || opt->list ||
+        (in->framed == 1 && (in->hdr.flags & GSEA_HDR_ARCHIVE))){
+        int ar = gsea_archive_extract(opt, in->framed == 1 ? &in->hdr : NULL);
+        if (ar <= 0) return ar;
+    }
+
+    // "-" como entrada o salida: un pipe no tiene tamaño ni admite pread, así
+    // que se procesa siempre en modo stream
+    if (gsea_is_stdio(opt->in_path) || gsea_is_stdio(opt->out_path)){
+        gsea_opts_t sopt = *opt;
+        sopt.stream = 1;
+        return gsea_process_stream(&sopt);
+    }
+
+    // sin operaciones: copia en kernel, sin pasar los datos por user-space
+    if (opt->ops_count == 0){
+        return fs_copy_file(opt->in_path, opt->out_path);
+    }
+
+    // modo stream: memoria acotada por el tamaño de bloque
+    if (opt->stream){
+        return gsea_process_stream(opt);
+    }
+    // -d/-u sobre un contenedor: se detecta solo y se decodifica por bloques
+    if ((first == 'd' || first == 'u') && in->framed == 1){
+        return gsea_process_blocks(opt, &in->hdr);
+    }
+    if (opt->use_mmap){
+        return process_file_mmap(opt, w);
+    }
+
+    // 1. leer archivo completo de entrada en el buffer del worker
     int fd = open(opt->in_path, O_RDONLY);
     if (fd < 0){
         perror("open in");
@@ -30,209 +441,48 @@ int gsea_process_file(const gsea_opts_t *opt){
     }
 
     size_t inlen = st.st_size;
-    uint8_t *inbuf = malloc(inlen ? inlen : 1);
-    if (!inbuf){
+    // con lugar para el padding, así un cifrado inicial trabaja en el lugar
+    if (gsea_worker_reserve(w, &w->in, inlen + GSEA_CODEC_MAX_PAD) != 0){
         perror("malloc");
         close(fd);
         return -1;
     }
 
     if (inlen > 0){
-        ssize_t r = read(fd, inbuf, inlen);
+        int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+        ssize_t r = read(fd, w->in.data, inlen);
         if (r != (ssize_t)inlen){
             perror("read");
-            free(inbuf);
             close(fd);
             return -1;
         }
+        if (gsea_stats_on) gsea_stats_stage("read", NULL, inlen, inlen, gsea_stats_now() - t0);
     }
     close(fd);
 
-    // buffer actual sobre el que aplicamos las operaciones
-    uint8_t *cur = inbuf;
-    size_t curlen = inlen;
-
     // 2. aplicar operaciones en el orden que indicó el usuario
-    for (int i = 0; i < opt->ops_count; i++){
-        char op = opt->ops_order[i];
-        uint8_t *tmp = NULL;
-        size_t tmplen = 0;
-
-        if (op == 'c'){             // comprimir
-            const char *alg = opt->comp_alg ? opt->comp_alg : "rle";
-            if (strcmp(alg, "rle") == 0){
-                if (rle_compress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo RLE compress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "lzw") == 0){
-                if (lzw_compress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo LZW compress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "huffman") == 0){
-                if (huffman_compress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo Huffman compress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else {
-                fprintf(stderr, "error: algoritmo de compresión '%s' no soportado\n", alg);
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-        } else if (op == 'd'){      // descomprimir
-            const char *alg = opt->comp_alg ? opt->comp_alg : "rle";
-            if (strcmp(alg, "rle") == 0){
-                if (rle_decompress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo RLE decompress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "lzw") == 0){
-                if (lzw_decompress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo LZW decompress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "huffman") == 0){
-                if (huffman_decompress(cur, curlen, &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo Huffman decompress\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else {
-                fprintf(stderr, "error: algoritmo de compresión '%s' no soportado para -d\n", alg);
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-        } else if (op == 'e'){      // encriptar
-            if (!opt->key){
-                fprintf(stderr, "error: se pidió -e pero no se pasó -k clave\n");
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-            const char *alg = opt->enc_alg ? opt->enc_alg : "vigenere";
-            if (strcmp(alg, "vigenere") == 0){
-                if (vig_encrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo vigenere encrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "des") == 0){
-                if (des_encrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo DES encrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "aes") == 0){
-                if (aes_encrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo AES encrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else {
-                fprintf(stderr, "error: algoritmo de encriptación '%s' no soportado\n", alg);
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-        } else if (op == 'u'){      // desencriptar
-            if (!opt->key){
-                fprintf(stderr, "error: se pidió -u pero no se pasó -k clave\n");
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-            const char *alg = opt->enc_alg ? opt->enc_alg : "vigenere";
-            if (strcmp(alg, "vigenere") == 0){
-                if (vig_decrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo vigenere decrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "des") == 0){
-                if (des_decrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo DES decrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else if (strcmp(alg, "aes") == 0){
-                if (aes_decrypt(cur, curlen,
-                                (const uint8_t*)opt->key, strlen(opt->key),
-                                &tmp, &tmplen) != 0){
-                    fprintf(stderr, "error: fallo AES decrypt\n");
-                    if (cur != inbuf) free(cur);
-                    free(inbuf);
-                    return -1;
-                }
-            } else {
-                fprintf(stderr, "error: algoritmo de encriptación '%s' no soportado para -u\n", alg);
-                if (cur != inbuf) free(cur);
-                free(inbuf);
-                return -1;
-            }
-        } else {
-            fprintf(stderr, "error: operación desconocida '%c'\n", op);
-            if (cur != inbuf) free(cur);
-            free(inbuf);
-            return -1;
-        }
-
-        if (tmp){
-            if (cur != inbuf) free(cur);
-            cur = tmp;
-            curlen = tmplen;
-        }
+    const uint8_t *cur = NULL;
+    size_t curlen = 0;
+    if (gsea_apply_ops_ws(opt, w, w->in.data, inlen, &cur, &curlen) != 0){
+        return -1;
     }
 
     // 3. escribir archivo de salida
     int fd_out = open(opt->out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (fd_out < 0){
         perror("open out");
-        if (cur != inbuf) free(cur);
-        free(inbuf);
         return -1;
     }
     if (curlen > 0){
-        ssize_t w = write(fd_out, cur, curlen);
-        if (w != (ssize_t)curlen){
+        int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+        ssize_t wr = write(fd_out, cur, curlen);
+        if (wr != (ssize_t)curlen){
             perror("write");
             close(fd_out);
-            if (cur != inbuf) free(cur);
-            free(inbuf);
             return -1;
         }
+        if (gsea_stats_on) gsea_stats_stage("write", NULL, curlen, curlen, gsea_stats_now() - t0);
     }
     close(fd_out);
-
-    if (cur != inbuf) free(cur);
-    free(inbuf);
     return 0;
 }
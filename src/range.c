@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "container.h"
+#include "stream.h"
+
+// primer bloque cuyo rango [start[i], start[i+1]) contiene 'off'
+static size_t find_block(const uint64_t *start, size_t n, uint64_t off){
+    size_t lo = 0, hi = n;
+    while (hi - lo > 1){
+        size_t mid = lo + (hi - lo) / 2;
+        if (start[mid] <= off) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int gsea_process_range(const gsea_opts_t *opt){
+    gsea_stream_t st;
+    if (gsea_stream_open(opt, NULL, &st) != 0) return -1;
+    if (!st.plan.framed_in || st.plan.framed_out){
+        fprintf(stderr, "error: --range requiere un contenedor y la cadena inversa completa\n");
+        return gsea_stream_close(&st, -1);
+    }
+
+    gsea_index_t idx;
+    if (gsea_index_read(st.src.fd, gsea_header_size(&st.plan.in_hdr),
+                        gsea_frame_hdr_size(st.src.hdr.version), &idx) != 0){
+        return gsea_stream_close(&st, -1);
+    }
+
+    // offset original de cada bloque (prefijos de raw_len)
+    uint64_t *start = malloc((idx.n + 1) * sizeof(*start));
+    if (!start){
+        perror("malloc");
+        gsea_index_free(&idx);
+        return gsea_stream_close(&st, -1);
+    }
+    start[0] = 0;
+    for (size_t i = 0; i < idx.n; i++) start[i + 1] = start[i] + idx.v[i].raw_len;
+    uint64_t total = start[idx.n];
+
+    uint64_t off = opt->range_off;
+    if (opt->range_from_end) off = off > total ? 0 : total - off;
+    if (off > total) off = total;
+    uint64_t end = opt->range_len == UINT64_MAX || opt->range_len > total - off
+                 ? total : off + opt->range_len;
+
+    int rc = 0;
+    // solo se leen y decodifican los bloques que cubren [off, end)
+    for (size_t b = off < end ? find_block(start, idx.n, off) : idx.n;
+         b < idx.n && start[b] < end; b++){
+        const gsea_block_t *blk = &idx.v[b];
+        uint8_t *in = NULL;
+        gsea_blkinfo_t info;
+        if (gsea_frame_load(st.src.fd, &st.src.hdr, blk, &in, &info) != 0){
+            rc = -1;
+            break;
+        }
+
+        uint8_t *res = NULL;
+        size_t reslen = 0;
+        rc = gsea_plan_apply(&st.plan, opt, info.raw_len, 0, st.plan.nsteps,
+                             in, blk->stored_len, &res, &reslen);
+        free(in);
+        if (rc != 0) break;
+        if (gsea_sink_check(&st.sink, res, reslen, &info) != 0){
+            free(res);
+            rc = -1;
+            break;
+        }
+
+        uint64_t from = off > start[b] ? off - start[b] : 0;
+        uint64_t to = end < start[b + 1] ? end - start[b] : reslen;
+        if (gsea_write_full(st.sink.fd, res + from, (size_t)(to - from)) != 0){
+            perror("write");
+            rc = -1;
+        }
+        free(res);
+        if (rc != 0) break;
+    }
+
+    free(start);
+    gsea_index_free(&idx);
+    return gsea_stream_close(&st, rc);
+}
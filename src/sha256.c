@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sha256.h"
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n){
+    return (x >> n) | (x << (32 - n));
+}
+
+static void compress(uint32_t h[8], const uint8_t *p){
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++){
+        w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 |
+               (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++){
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+    uint32_t e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++){
+        uint32_t t1 = k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                      ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+                      ((a & b) ^ (a & c) ^ (b & c));
+        k = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+void gsea_sha256_init(gsea_sha256_t *s){
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(s->h, iv, sizeof(iv));
+    s->len = 0;
+    s->nbuf = 0;
+}
+
+void gsea_sha256_update(gsea_sha256_t *s, const void *data, size_t n){
+    const uint8_t *p = data;
+    s->len += n;
+    if (s->nbuf > 0){
+        size_t take = 64 - s->nbuf < n ? 64 - s->nbuf : n;
+        memcpy(s->buf + s->nbuf, p, take);
+        s->nbuf += take;
+        p += take;
+        n -= take;
+        if (s->nbuf < 64) return;
+        compress(s->h, s->buf);
+        s->nbuf = 0;
+    }
+    for (; n >= 64; p += 64, n -= 64) compress(s->h, p);
+    memcpy(s->buf, p, n);
+    s->nbuf = n;
+}
+
+void gsea_sha256_final(gsea_sha256_t *s, uint8_t out[GSEA_SHA256_LEN]){
+    uint64_t bits = s->len * 8;
+    uint8_t pad[72] = { 0x80 };
+    // 0x80, ceros hasta 56 mod 64 y el largo en bits big-endian
+    size_t npad = (s->nbuf < 56 ? 56 : 120) - s->nbuf;
+    for (int i = 0; i < 8; i++) pad[npad + i] = (uint8_t)(bits >> (56 - 8 * i));
+    gsea_sha256_update(s, pad, npad + 8);
+    for (int i = 0; i < 8; i++){
+        out[4 * i]     = (uint8_t)(s->h[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(s->h[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(s->h[i] >> 8);
+        out[4 * i + 3] = (uint8_t)s->h[i];
+    }
+}
+
+int gsea_sha256_file(const char *path, uint8_t out[GSEA_SHA256_LEN]){
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    enum { BUF = 1 << 16 };
+    uint8_t *buf = malloc(BUF);
+    if (!buf){
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+    gsea_sha256_t s;
+    gsea_sha256_init(&s);
+    int rc = 0;
+    for (;;){
+        ssize_t r = read(fd, buf, BUF);
+        if (r < 0){
+            if (errno == EINTR) continue;
+            rc = -1;
+            break;
+        }
+        if (r == 0) break;
+        gsea_sha256_update(&s, buf, (size_t)r);
+    }
+    int err = errno;
+    free(buf);
+    close(fd);
+    if (rc != 0){
+        errno = err;
+        return -1;
+    }
+    gsea_sha256_final(&s, out);
+    return 0;
+}
+
+void gsea_pbkdf2_sha256(const void *pass, size_t plen, const uint8_t *salt, size_t slen,
+                        unsigned iters, uint8_t out[GSEA_SHA256_LEN]){
+    // HMAC (RFC 2104): los estados tras la clave con ipad y opad se preparan
+    // una vez y se copian en cada iteración
+    uint8_t k[64], pad[64];
+    memset(k, 0, sizeof(k));
+    if (plen > sizeof(k)){
+        gsea_sha256_t s;
+        gsea_sha256_init(&s);
+        gsea_sha256_update(&s, pass, plen);
+        gsea_sha256_final(&s, k);
+    } else {
+        memcpy(k, pass, plen);
+    }
+    gsea_sha256_t in, outer;
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x36;
+    gsea_sha256_init(&in);
+    gsea_sha256_update(&in, pad, sizeof(pad));
+    for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x5c;
+    gsea_sha256_init(&outer);
+    gsea_sha256_update(&outer, pad, sizeof(pad));
+
+    // primer bloque de PBKDF2 (RFC 8018): U1 = HMAC(P, S || 1),
+    // Ui = HMAC(P, Ui-1) y el resultado es U1 ^ U2 ^ ... ^ Uc
+    static const uint8_t one[4] = { 0, 0, 0, 1 };
+    uint8_t u[GSEA_SHA256_LEN];
+    gsea_sha256_t s = in;
+    gsea_sha256_update(&s, salt, slen);
+    gsea_sha256_update(&s, one, sizeof(one));
+    for (unsigned it = 0; it < iters; it++){
+        if (it > 0){
+            s = in;
+            gsea_sha256_update(&s, u, sizeof(u));
+        }
+        gsea_sha256_final(&s, u);
+        s = outer;
+        gsea_sha256_update(&s, u, sizeof(u));
+        gsea_sha256_final(&s, u);
+        if (it == 0) memcpy(out, u, sizeof(u));
+        else for (int i = 0; i < GSEA_SHA256_LEN; i++) out[i] ^= u[i];
+    }
+    memset(k, 0, sizeof(k));
+    memset(pad, 0, sizeof(pad));
+}
@@ -0,0 +1,244 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "stream.h"
+#include "pool.h"
+
+// bloques en vuelo por cola; con 2 cada etapa puede adelantar un bloque
+#define RING_SLOTS 2
+
+// un bloque que viaja entre etapas (eof marca el fin del flujo)
+typedef struct {
+    uint8_t *data;
+    size_t   len;
+    gsea_blkinfo_t info;
+    int      eof;
+} stage_item_t;
+
+// cola acotada productor-único/consumidor-único
+typedef struct {
+    stage_item_t slots[RING_SLOTS];
+    size_t head;                  // próximo a leer
+    size_t tail;                  // próximo a escribir
+    int aborted;
+    pthread_mutex_t lock;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+} ring_t;
+
+static void ring_init(ring_t *r){
+    memset(r, 0, sizeof(*r));
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->not_empty, NULL);
+    pthread_cond_init(&r->not_full, NULL);
+}
+
+static void ring_destroy(ring_t *r){
+    // liberar bloques que quedaron en la cola si se abortó
+    while (r->head != r->tail){
+        free(r->slots[r->head % RING_SLOTS].data);
+        r->head++;
+    }
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->not_empty);
+    pthread_cond_destroy(&r->not_full);
+}
+
+// 0 en éxito, -1 si la cola fue abortada (el item no se encola)
+static int ring_push(ring_t *r, const stage_item_t *it){
+    pthread_mutex_lock(&r->lock);
+    while (r->tail - r->head == RING_SLOTS && !r->aborted){
+        pthread_cond_wait(&r->not_full, &r->lock);
+    }
+    if (r->aborted){
+        pthread_mutex_unlock(&r->lock);
+        return -1;
+    }
+    r->slots[r->tail % RING_SLOTS] = *it;
+    r->tail++;
+    pthread_cond_signal(&r->not_empty);
+    pthread_mutex_unlock(&r->lock);
+    return 0;
+}
+
+static int ring_pop(ring_t *r, stage_item_t *it){
+    pthread_mutex_lock(&r->lock);
+    while (r->tail == r->head && !r->aborted){
+        pthread_cond_wait(&r->not_empty, &r->lock);
+    }
+    if (r->aborted){
+        pthread_mutex_unlock(&r->lock);
+        return -1;
+    }
+    *it = r->slots[r->head % RING_SLOTS];
+    r->head++;
+    pthread_cond_signal(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+    return 0;
+}
+
+static void ring_abort(ring_t *r){
+    pthread_mutex_lock(&r->lock);
+    r->aborted = 1;
+    pthread_cond_broadcast(&r->not_empty);
+    pthread_cond_broadcast(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+}
+
+struct stage_pipe {
+    const gsea_opts_t *opt;
+    gsea_stream_t st;
+    ring_t *rings;                // plan.nsteps + 1 colas
+    int nrings;
+    pthread_mutex_t err_lock;
+    int failed;
+};
+
+struct stage_arg {
+    struct stage_pipe *p;
+    int idx;                      // índice del paso en el plan
+};
+
+// ante un error cualquier etapa despierta y detiene a todas las demás
+static void pipe_fail(struct stage_pipe *p){
+    pthread_mutex_lock(&p->err_lock);
+    p->failed = 1;
+    pthread_mutex_unlock(&p->err_lock);
+    for (int i = 0; i < p->nrings; i++) ring_abort(&p->rings[i]);
+}
+
+static int pipe_failed(struct stage_pipe *p){
+    pthread_mutex_lock(&p->err_lock);
+    int f = p->failed;
+    pthread_mutex_unlock(&p->err_lock);
+    return f;
+}
+
+static int stage_worker(void *ptr){
+    struct stage_arg *a = ptr;
+    struct stage_pipe *p = a->p;
+    ring_t *in  = &p->rings[a->idx];
+    ring_t *out = &p->rings[a->idx + 1];
+
+    for (;;){
+        stage_item_t it;
+        if (ring_pop(in, &it) != 0) break;
+        if (it.eof){
+            ring_push(out, &it);
+            break;
+        }
+        stage_item_t res = { NULL, 0, it.info, 0 };
+        int ar = gsea_plan_apply(&p->st.plan, p->opt, it.info.raw_len,
+                                 a->idx, a->idx + 1, it.data, it.len, &res.data, &res.len);
+        free(it.data);
+        // la última etapa comprueba el original, así no frena al escritor
+        if (ar == 0 && a->idx == p->st.plan.nsteps - 1 &&
+            gsea_sink_check(&p->st.sink, res.data, res.len, &res.info) != 0){
+            free(res.data);
+            ar = -1;
+        }
+        if (ar != 0){
+            pipe_fail(p);
+            break;
+        }
+        if (ring_push(out, &res) != 0){
+            free(res.data);
+            break;
+        }
+    }
+    return 0;
+}
+
+static int writer_worker(void *ptr){
+    struct stage_pipe *p = ptr;
+    ring_t *in = &p->rings[p->nrings - 1];
+
+    for (;;){
+        stage_item_t it;
+        if (ring_pop(in, &it) != 0) break;
+        if (it.eof) break;
+        int wr = gsea_sink_put(&p->st.sink, it.data, it.len, &it.info);
+        free(it.data);
+        if (wr != 0){
+            pipe_fail(p);
+            break;
+        }
+    }
+    return 0;
+}
+
+// el hilo llamador hace de lector y alimenta la primera cola
+static void read_loop(struct stage_pipe *p){
+    for (;;){
+        stage_item_t it = { NULL, 0, { 0, 0 }, 0 };
+        int nr = gsea_source_next(&p->st.src, &it.data, &it.len, &it.info);
+        if (nr < 0){
+            pipe_fail(p);
+            return;
+        }
+        if (nr == 0) it.eof = 1;
+
+        if (ring_push(&p->rings[0], &it) != 0){
+            free(it.data);
+            return;
+        }
+        if (it.eof) return;
+    }
+}
+
+int gsea_process_stream_pipelined(const gsea_opts_t *opt){
+    struct stage_pipe p;
+    memset(&p, 0, sizeof(p));
+    p.opt = opt;
+    if (gsea_stream_open(opt, NULL, &p.st) != 0) return -1;
+
+    int nsteps = p.st.plan.nsteps;
+    p.nrings = nsteps + 1;
+    p.rings = calloc((size_t)p.nrings, sizeof(*p.rings));
+    struct stage_arg *args = calloc((size_t)nsteps + 1, sizeof(*args));
+    gsea_pool_t *pool = gsea_pool_shared();
+    if (!p.rings || !args || !pool){
+        perror("calloc etapas");
+        free(p.rings);
+        free(args);
+        return gsea_stream_close(&p.st, -1);
+    }
+    for (int i = 0; i < p.nrings; i++) ring_init(&p.rings[i]);
+    pthread_mutex_init(&p.err_lock, NULL);
+
+    // una tarea por paso más el escritor; se esperan entre sí por las
+    // colas, así que cada una necesita su propio hilo del pool
+    gsea_group_t g;
+    gsea_group_init(&g);
+    int started = 0;
+    for (int i = 0; i < nsteps; i++){
+        args[i].p = &p;
+        args[i].idx = i;
+        if (gsea_pool_spawn(pool, &g, stage_worker, &args[i]) != 0){
+            pipe_fail(&p);
+            break;
+        }
+        started++;
+    }
+    if (started == nsteps && gsea_pool_spawn(pool, &g, writer_worker, &p) != 0){
+        pipe_fail(&p);
+    }
+
+    if (!pipe_failed(&p)) read_loop(&p);
+
+    gsea_pool_wait(pool, &g);
+    gsea_group_destroy(&g);
+
+    int rc = p.failed ? -1 : 0;
+    for (int i = 0; i < p.nrings; i++) ring_destroy(&p.rings[i]);
+    pthread_mutex_destroy(&p.err_lock);
+    free(p.rings);
+    free(args);
+    return gsea_stream_close(&p.st, rc);
+}
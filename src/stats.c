@@ -0,0 +1,298 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "arena.h"
+#include "log.h"
+
+#define MAX_STAGES 24
+
+typedef struct {
+    const char *name, *verb;
+    uint64_t calls, in, out;
+    int64_t ns;
+} stage_t;
+
+typedef struct {
+    const char *path;
+    uint64_t in, out;
+    int64_t start, end, wait;
+    unsigned thread;
+    int ok;
+} file_rec_t;
+
+// lo que mide un hilo; solo lo toca ese hilo hasta el reporte
+typedef struct shard {
+    struct shard *next;
+    unsigned id;
+    stage_t stages[MAX_STAGES];
+    size_t nstages;
+    file_rec_t *files;
+    size_t nfiles, cap;
+    gsea_strarena_t paths;
+    uint64_t tasks;
+    int64_t task_wait, task_wait_max, task_run;
+    uint64_t workers;
+    int64_t alive, busy;
+} shard_t;
+
+int gsea_stats_on;
+static const char *report_path;
+static int64_t t_start;
+static size_t pool_threads;
+
+static pthread_key_t shard_key;
+static pthread_once_t shard_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t shard_lock = PTHREAD_MUTEX_INITIALIZER;
+static shard_t *shards;
+static unsigned nshards;
+
+int64_t gsea_stats_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void shard_key_init(void){
+    // las tablas sobreviven a sus hilos: se leen en el reporte
+    pthread_key_create(&shard_key, NULL);
+}
+
+static shard_t *shard_get(void){
+    pthread_once(&shard_once, shard_key_init);
+    shard_t *s = pthread_getspecific(shard_key);
+    if (s) return s;
+    s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_lock(&shard_lock);
+    s->id = nshards++;
+    s->next = shards;
+    shards = s;
+    pthread_mutex_unlock(&shard_lock);
+    pthread_setspecific(shard_key, s);
+    return s;
+}
+
+void gsea_stats_stage(const char *name, const char *verb,
+                      uint64_t in, uint64_t out, int64_t ns){
+    shard_t *s = shard_get();
+    if (!s) return;
+    stage_t *st = NULL;
+    for (size_t i = 0; i < s->nstages; i++){
+        if (s->stages[i].name == name && s->stages[i].verb == verb){
+            st = &s->stages[i];
+            break;
+        }
+    }
+    if (!st){
+        if (s->nstages == MAX_STAGES) return;
+        st = &s->stages[s->nstages++];
+        st->name = name;
+        st->verb = verb;
+    }
+    st->calls++;
+    st->in += in;
+    st->out += out;
+    st->ns += ns;
+}
+
+void gsea_stats_file(const char *path, uint64_t in, uint64_t out,
+                     int64_t start, int64_t end, int64_t wait, int ok){
+    shard_t *s = shard_get();
+    if (!s) return;
+    if (s->nfiles == s->cap){
+        size_t ncap = s->cap ? s->cap * 2 : 256;
+        file_rec_t *nf = realloc(s->files, ncap * sizeof(*nf));
+        if (!nf) return;
+        s->files = nf;
+        s->cap = ncap;
+    }
+    size_t len = strlen(path) + 1;
+    char *copy = gsea_strarena_alloc(&s->paths, len);
+    if (!copy) return;
+    memcpy(copy, path, len);
+    s->files[s->nfiles++] = (file_rec_t){ copy, in, out, start, end, wait, s->id, ok };
+}
+
+void gsea_stats_worker(int64_t alive, int64_t busy){
+    shard_t *s = shard_get();
+    if (!s) return;
+    s->workers++;
+    s->alive += alive;
+    s->busy += busy;
+}
+
+void gsea_stats_task(int64_t wait, int64_t run){
+    shard_t *s = shard_get();
+    if (!s) return;
+    s->tasks++;
+    s->task_wait += wait;
+    s->task_run += run;
+    if (wait > s->task_wait_max) s->task_wait_max = wait;
+}
+
+void gsea_stats_thread_added(void){
+    __atomic_fetch_add(&pool_threads, 1, __ATOMIC_RELAXED);
+}
+
+static double ms(int64_t ns){
+    return (double)ns / 1e6;
+}
+
+static double ratio(uint64_t out, uint64_t in){
+    return in ? (double)out / (double)in : 0.0;
+}
+
+static void json_str(FILE *f, const char *s){
+    fputc('"', f);
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++){
+        if (*p == '"' || *p == '\\') fprintf(f, "\\%c", *p);
+        else if (*p < 0x20) fprintf(f, "\\u%04x", *p);
+        else fputc(*p, f);
+    }
+    fputc('"', f);
+}
+
+static int file_cmp(const void *a, const void *b){
+    const file_rec_t *x = *(file_rec_t *const *)a, *y = *(file_rec_t *const *)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return strcmp(x->path, y->path);
+}
+
+static void report(FILE *f){
+    int64_t elapsed = gsea_stats_now() - t_start;
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    pthread_mutex_lock(&shard_lock);
+    shard_t *list = shards;
+    pthread_mutex_unlock(&shard_lock);
+
+    // sumar las tablas de todos los hilos
+    stage_t stages[MAX_STAGES];
+    size_t nstages = 0;
+    uint64_t tasks = 0, workers = 0;
+    int64_t task_wait = 0, task_wait_max = 0, task_run = 0, alive = 0, busy = 0;
+    size_t nfiles = 0;
+    for (shard_t *s = list; s; s = s->next){
+        for (size_t i = 0; i < s->nstages; i++){
+            const stage_t *src = &s->stages[i];
+            size_t k = 0;
+            while (k < nstages &&
+                   !(strcmp(stages[k].name, src->name) == 0 &&
+                     (stages[k].verb == src->verb ||
+                      (stages[k].verb && src->verb && strcmp(stages[k].verb, src->verb) == 0)))){
+                k++;
+            }
+            if (k == nstages){
+                if (nstages == MAX_STAGES) continue;
+                stages[nstages++] = (stage_t){ src->name, src->verb, 0, 0, 0, 0 };
+            }
+            stages[k].calls += src->calls;
+            stages[k].in += src->in;
+            stages[k].out += src->out;
+            stages[k].ns += src->ns;
+        }
+        tasks += s->tasks;
+        task_wait += s->task_wait;
+        task_run += s->task_run;
+        if (s->task_wait_max > task_wait_max) task_wait_max = s->task_wait_max;
+        workers += s->workers;
+        alive += s->alive;
+        busy += s->busy;
+        nfiles += s->nfiles;
+    }
+
+    fprintf(f, "{\n  \"elapsed_ms\": %.3f,\n  \"cpu_user_ms\": %.3f,\n  \"cpu_sys_ms\": %.3f,\n"
+               "  \"peak_rss_kb\": %ld,\n",
+            ms(elapsed),
+            (double)ru.ru_utime.tv_sec * 1e3 + (double)ru.ru_utime.tv_usec / 1e3,
+            (double)ru.ru_stime.tv_sec * 1e3 + (double)ru.ru_stime.tv_usec / 1e3,
+            ru.ru_maxrss);
+
+    fprintf(f, "  \"stages\": [");
+    for (size_t i = 0; i < nstages; i++){
+        const stage_t *st = &stages[i];
+        fprintf(f, "%s\n    {\"name\": \"%s%s%s\", \"calls\": %llu, \"bytes_in\": %llu, "
+                   "\"bytes_out\": %llu, \"ms\": %.3f, \"mb_s\": %.1f, \"ratio\": %.4f}",
+                i ? "," : "", st->name, st->verb ? " " : "", st->verb ? st->verb : "",
+                (unsigned long long)st->calls, (unsigned long long)st->in,
+                (unsigned long long)st->out, ms(st->ns),
+                st->ns > 0 ? (double)st->in / 1e6 / ((double)st->ns / 1e9) : 0.0,
+                ratio(st->out, st->in));
+    }
+    fprintf(f, "%s],\n", nstages ? "\n  " : "");
+
+    size_t nthreads = __atomic_load_n(&pool_threads, __ATOMIC_RELAXED);
+    fprintf(f, "  \"pool\": {\"threads\": %zu, \"tasks\": %llu, \"task_wait_ms\": %.3f, "
+               "\"task_wait_max_ms\": %.3f, \"task_run_ms\": %.3f, \"utilization\": %.4f},\n",
+            nthreads, (unsigned long long)tasks, ms(task_wait), ms(task_wait_max), ms(task_run),
+            nthreads && elapsed > 0 ? (double)task_run / ((double)nthreads * (double)elapsed) : 0.0);
+
+    // archivos en orden de inicio
+    file_rec_t **files = malloc((nfiles ? nfiles : 1) * sizeof(*files));
+    size_t nf = 0;
+    uint64_t fin = 0, fout = 0;
+    int64_t wait = 0, wait_max = 0;
+    for (shard_t *s = list; s; s = s->next){
+        for (size_t i = 0; i < s->nfiles; i++){
+            file_rec_t *r = &s->files[i];
+            if (files) files[nf++] = r;
+            fin += r->in;
+            fout += r->out;
+            wait += r->wait;
+            if (r->wait > wait_max) wait_max = r->wait;
+        }
+    }
+    fprintf(f, "  \"dir\": {\"workers\": %llu, \"busy_ms\": %.3f, \"alive_ms\": %.3f, "
+               "\"utilization\": %.4f, \"files\": %zu, \"bytes_in\": %llu, \"bytes_out\": %llu, "
+               "\"ratio\": %.4f, \"wait_ms\": %.3f, \"wait_max_ms\": %.3f},\n",
+            (unsigned long long)workers, ms(busy), ms(alive),
+            alive > 0 ? (double)busy / (double)alive : 0.0, nfiles,
+            (unsigned long long)fin, (unsigned long long)fout, ratio(fout, fin),
+            ms(wait), ms(wait_max));
+
+    qsort(files, nf, sizeof(*files), file_cmp);
+    fprintf(f, "  \"files\": [");
+    for (size_t i = 0; i < nf; i++){
+        const file_rec_t *r = files[i];
+        fprintf(f, "%s\n    {\"path\": ", i ? "," : "");
+        json_str(f, r->path);
+        fprintf(f, ", \"bytes_in\": %llu, \"bytes_out\": %llu, \"ratio\": %.4f, "
+                   "\"start_ms\": %.3f, \"ms\": %.3f, \"wait_ms\": %.3f, \"thread\": %u, \"ok\": %s}",
+                (unsigned long long)r->in, (unsigned long long)r->out, ratio(r->out, r->in),
+                ms(r->start - t_start), ms(r->end - r->start), ms(r->wait),
+                r->thread, r->ok ? "true" : "false");
+    }
+    fprintf(f, "%s]\n}\n", nf ? "\n  " : "");
+    free(files);
+}
+
+static void stats_atexit(void){
+    // los mensajes pendientes van antes que el reporte
+    gsea_log_flush();
+    if (!report_path){
+        report(stderr);
+        return;
+    }
+    FILE *f = fopen(report_path, "w");
+    if (!f){
+        perror("fopen stats");
+        return;
+    }
+    report(f);
+    if (fclose(f) != 0) perror("fclose stats");
+}
+
+void gsea_stats_init(const char *path){
+    report_path = path;
+    t_start = gsea_stats_now();
+    if (!gsea_stats_on){
+        gsea_stats_on = 1;
+        atexit(stats_atexit);
+    }
+}
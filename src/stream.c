@@ -0,0 +1,553 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "gsea.h"
+#include "pipeline.h"
+#include "stream.h"
+#include "crc32c.h"
+#include "stats.h"
+#include "codec.h"
+
+static void put_u32(uint8_t *p, uint32_t v){
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void put_u64(uint8_t *p, uint64_t v){
+    put_u32(p, (uint32_t)(v >> 32));
+    put_u32(p + 4, (uint32_t)v);
+}
+
+static uint64_t get_u64(const uint8_t *p){
+    return ((uint64_t)get_u32(p) << 32) | get_u32(p + 4);
+}
+
+ssize_t gsea_read_full(int fd, uint8_t *buf, size_t n){
+    int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+    size_t got = 0;
+    while (got < n){
+        ssize_t r = read(fd, buf + got, n - got);
+        if (r < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break;          // EOF
+        got += (size_t)r;
+    }
+    if (gsea_stats_on) gsea_stats_stage("read", NULL, got, got, gsea_stats_now() - t0);
+    return (ssize_t)got;
+}
+
+int gsea_open_in(const char *path){
+    return gsea_is_stdio(path) ? STDIN_FILENO : open(path, O_RDONLY);
+}
+
+int gsea_open_out(const char *path){
+    if (gsea_is_stdio(path)) return STDOUT_FILENO;
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+int gsea_close_fd(int fd){
+    // stdin/stdout los cierra el proceso al salir
+    if (fd < 0 || fd == STDIN_FILENO || fd == STDOUT_FILENO) return 0;
+    return close(fd);
+}
+
+int gsea_pread_full(int fd, uint8_t *buf, size_t n, uint64_t off){
+    int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+    size_t got = 0;
+    while (got < n){
+        ssize_t r = pread(fd, buf + got, n - got, (off_t)(off + got));
+        if (r < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) return -1;      // EOF prematuro
+        got += (size_t)r;
+    }
+    if (gsea_stats_on) gsea_stats_stage("read", NULL, n, n, gsea_stats_now() - t0);
+    return 0;
+}
+
+int gsea_write_full(int fd, const uint8_t *buf, size_t n){
+    int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+    size_t done = 0;
+    while (done < n){
+        ssize_t w = write(fd, buf + done, n - done);
+        if (w < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += (size_t)w;
+    }
+    if (gsea_stats_on) gsea_stats_stage("write", NULL, n, n, gsea_stats_now() - t0);
+    return 0;
+}
+
+int gsea_frame_write(int fd, const uint8_t *payload, uint32_t stored_len,
+                     const gsea_blkinfo_t *info){
+    uint8_t hdr[GSEA_FRAME_HDR];
+    put_u32(hdr, stored_len);
+    put_u32(hdr + 4, info ? info->raw_len : 0);
+    put_u32(hdr + 8, stored_len ? gsea_crc32c(payload, stored_len) : 0);
+    put_u32(hdr + 12, info ? info->raw_crc : 0);
+    if (gsea_write_full(fd, hdr, sizeof(hdr)) != 0) return -1;
+    if (stored_len > 0 && gsea_write_full(fd, payload, stored_len) != 0) return -1;
+    return 0;
+}
+
+// El frame más grande que puede escribir el contenedor 'h': un bloque de
+// chunk_size bytes con la peor cota de cada paso de su cadena. Un stored_len
+// mayor (o un raw_len mayor que chunk_size) solo sale de un frame dañado o
+// armado a mano, y se rechaza antes de reservar memoria para él
+static uint64_t frame_max(const gsea_header_t *h){
+    size_t n = h->chunk_size ? h->chunk_size : GSEA_DEFAULT_CHUNK;
+    for (int i = 0; i < h->nsteps; i++){
+        const gsea_codec_t *c = gsea_codec_by_id(h->steps[i].alg);
+        size_t b;
+        if (!c || c->forward_bound(NULL, n, &b) != 0) return UINT32_MAX;
+        n = b;
+    }
+    return (uint64_t)n;
+}
+
+static int frame_len_ok(const gsea_header_t *h, uint32_t stored_len, uint32_t raw_len,
+                        uint64_t off){
+    uint32_t chunk = h->chunk_size ? h->chunk_size : GSEA_DEFAULT_CHUNK;
+    int stored_ok = stored_len <= frame_max(h);
+    if (stored_ok && raw_len <= chunk) return 1;
+    uint32_t bad = stored_ok ? raw_len : stored_len;
+    if (off != UINT64_MAX){
+        fprintf(stderr, "error: frame corrupto en el offset %llu (tamaño %lu fuera de rango)\n",
+                (unsigned long long)off, (unsigned long)bad);
+    } else {
+        fprintf(stderr, "error: frame corrupto (tamaño %lu fuera de rango)\n",
+                (unsigned long)bad);
+    }
+    return 0;
+}
+
+// valida el payload contra el header del frame; 'off' solo es para el mensaje
+static int frame_check(const uint8_t *hdr, const gsea_header_t *h, const uint8_t *payload,
+                       uint32_t stored_len, gsea_blkinfo_t *info, uint64_t off){
+    info->raw_len = get_u32(hdr + 4);
+    info->raw_crc = 0;
+    if (h->version < 2) return 0;
+    info->raw_crc = get_u32(hdr + 12);
+    if (gsea_crc32c(payload, stored_len) != get_u32(hdr + 8)){
+        if (off != UINT64_MAX){
+            fprintf(stderr, "error: bloque corrupto en el offset %llu (CRC32C no coincide)\n",
+                    (unsigned long long)off);
+        } else {
+            fprintf(stderr, "error: bloque corrupto (CRC32C no coincide)\n");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int gsea_frame_read(int fd, const gsea_header_t *h, uint8_t **payload, uint32_t *stored_len,
+                    gsea_blkinfo_t *info){
+    uint8_t hdr[GSEA_FRAME_HDR];
+    size_t hlen = gsea_frame_hdr_size(h->version);
+    ssize_t r = gsea_read_full(fd, hdr, hlen);
+    if (r < 0){
+        perror("read frame");
+        return -1;
+    }
+    if (r != (ssize_t)hlen){
+        fprintf(stderr, "error: flujo truncado (falta marcador de fin)\n");
+        return -1;
+    }
+    *stored_len = get_u32(hdr);
+    if (*stored_len == 0){
+        *payload = NULL;
+        return 0;
+    }
+    if (!frame_len_ok(h, *stored_len, get_u32(hdr + 4), UINT64_MAX)) return -1;
+
+    *payload = malloc(*stored_len);
+    if (!*payload){
+        perror("malloc frame");
+        return -1;
+    }
+    r = gsea_read_full(fd, *payload, *stored_len);
+    if (r != (ssize_t)*stored_len){
+        fprintf(stderr, "error: frame truncado\n");
+        free(*payload);
+        *payload = NULL;
+        return -1;
+    }
+    if (frame_check(hdr, h, *payload, *stored_len, info, UINT64_MAX) != 0){
+        free(*payload);
+        *payload = NULL;
+        return -1;
+    }
+    return 1;
+}
+
+int gsea_frame_load(int fd, const gsea_header_t *h, const gsea_block_t *b,
+                    uint8_t **payload, gsea_blkinfo_t *info){
+    uint8_t hdr[GSEA_FRAME_HDR];
+    size_t hlen = gsea_frame_hdr_size(h->version);
+    *payload = NULL;
+    if (gsea_pread_full(fd, hdr, hlen, b->offset) != 0){
+        fprintf(stderr, "error: frame truncado en el offset %llu\n",
+                (unsigned long long)b->offset);
+        return -1;
+    }
+    if (get_u32(hdr) != b->stored_len){
+        fprintf(stderr, "error: la tabla de bloques no coincide con el frame en %llu\n",
+                (unsigned long long)b->offset);
+        return -1;
+    }
+    if (!frame_len_ok(h, b->stored_len, get_u32(hdr + 4), b->offset)) return -1;
+    *payload = malloc(b->stored_len ? b->stored_len : 1);
+    if (!*payload){
+        perror("malloc bloque");
+        return -1;
+    }
+    if (gsea_pread_full(fd, *payload, b->stored_len, b->offset + hlen) != 0){
+        fprintf(stderr, "error: frame truncado en el offset %llu\n",
+                (unsigned long long)b->offset);
+        free(*payload);
+        *payload = NULL;
+        return -1;
+    }
+    if (frame_check(hdr, h, *payload, b->stored_len, info, b->offset) != 0){
+        free(*payload);
+        *payload = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int gsea_index_add(gsea_index_t *idx, uint32_t stored_len, uint32_t raw_len){
+    if (idx->n == idx->cap){
+        size_t ncap = idx->cap ? idx->cap * 2 : 64;
+        gsea_block_t *nv = realloc(idx->v, ncap * sizeof(*nv));
+        if (!nv) return -1;
+        idx->v = nv;
+        idx->cap = ncap;
+    }
+    idx->v[idx->n].offset = idx->pos;
+    idx->v[idx->n].stored_len = stored_len;
+    idx->v[idx->n].raw_len = raw_len;
+    idx->n++;
+    idx->pos += idx->frame_hdr + (uint64_t)stored_len;
+    return 0;
+}
+
+int gsea_index_finish(int fd, const gsea_index_t *idx){
+    if (gsea_frame_write(fd, NULL, 0, NULL) != 0) return -1;
+    uint64_t table_off = idx->pos + idx->frame_hdr;
+
+    uint8_t ent[GSEA_INDEX_ENTRY];
+    for (size_t i = 0; i < idx->n; i++){
+        put_u64(ent, idx->v[i].offset);
+        put_u32(ent + 8, idx->v[i].stored_len);
+        put_u32(ent + 12, idx->v[i].raw_len);
+        if (gsea_write_full(fd, ent, sizeof(ent)) != 0) return -1;
+    }
+
+    uint8_t tail[GSEA_INDEX_TAIL];
+    put_u64(tail, table_off);
+    put_u32(tail + 8, (uint32_t)idx->n);
+    memcpy(tail + 12, "GSBT", 4);
+    return gsea_write_full(fd, tail, sizeof(tail));
+}
+
+// reconstruye la tabla recorriendo los headers de los frames
+static int index_scan(int fd, gsea_index_t *idx){
+    for (;;){
+        uint8_t hdr[GSEA_FRAME_HDR_V1];
+        if (gsea_pread_full(fd, hdr, sizeof(hdr), idx->pos) != 0){
+            fprintf(stderr, "error: flujo truncado (falta marcador de fin)\n");
+            return -1;
+        }
+        uint32_t stored = get_u32(hdr);
+        if (stored == 0) return 0;
+        if (gsea_index_add(idx, stored, get_u32(hdr + 4)) != 0) return -1;
+    }
+}
+
+int gsea_index_read(int fd, uint64_t start, size_t frame_hdr, gsea_index_t *idx){
+    memset(idx, 0, sizeof(*idx));
+    idx->pos = start;
+    idx->frame_hdr = frame_hdr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){
+        fprintf(stderr, "error: la entrada por bloques debe ser un archivo regular\n");
+        return -1;
+    }
+    uint64_t size = (uint64_t)st.st_size;
+
+    uint8_t tail[GSEA_INDEX_TAIL];
+    if (size >= start + frame_hdr + GSEA_INDEX_TAIL &&
+        gsea_pread_full(fd, tail, sizeof(tail), size - GSEA_INDEX_TAIL) == 0 &&
+        memcmp(tail + 12, "GSBT", 4) == 0){
+        uint64_t table_off = get_u64(tail);
+        uint32_t n = get_u32(tail + 8);
+        if (table_off >= start + frame_hdr &&
+            table_off + (uint64_t)n * GSEA_INDEX_ENTRY + GSEA_INDEX_TAIL == size){
+            uint8_t *raw = malloc((size_t)n * GSEA_INDEX_ENTRY + 1);
+            idx->v = malloc(((size_t)n + 1) * sizeof(*idx->v));
+            if (!raw || !idx->v ||
+                gsea_pread_full(fd, raw, (size_t)n * GSEA_INDEX_ENTRY, table_off) != 0){
+                free(raw);
+                gsea_index_free(idx);
+                return -1;
+            }
+            for (uint32_t i = 0; i < n; i++){
+                const uint8_t *e = raw + (size_t)i * GSEA_INDEX_ENTRY;
+                idx->v[i].offset = get_u64(e);
+                idx->v[i].stored_len = get_u32(e + 8);
+                idx->v[i].raw_len = get_u32(e + 12);
+            }
+            free(raw);
+            idx->n = idx->cap = n;
+            idx->pos = table_off - frame_hdr;
+            return 0;
+        }
+    }
+
+    // sin tabla válida: recorrer los frames
+    if (index_scan(fd, idx) != 0){
+        gsea_index_free(idx);
+        return -1;
+    }
+    return 0;
+}
+
+void gsea_index_free(gsea_index_t *idx){
+    free(idx->v);
+    memset(idx, 0, sizeof(*idx));
+}
+
+int gsea_source_next(gsea_source_t *src, uint8_t **buf, size_t *len,
+                     gsea_blkinfo_t *info){
+    if (src->framed){
+        uint32_t stored;
+        int fr = gsea_frame_read(src->fd, &src->hdr, buf, &stored, info);
+        *len = stored;
+        return fr;
+    }
+
+    *buf = malloc(src->chunk);
+    if (!*buf){
+        perror("malloc chunk");
+        return -1;
+    }
+    size_t pre = src->pre_len < src->chunk ? src->pre_len : src->chunk;
+    memcpy(*buf, src->pre, pre);
+    src->pre_len -= pre;
+    memmove(src->pre, src->pre + pre, src->pre_len);
+    ssize_t r = gsea_read_full(src->fd, *buf + pre, src->chunk - pre);
+    if (r >= 0) r += (ssize_t)pre;
+    if (r <= 0){
+        if (r < 0) perror("read");
+        free(*buf);
+        *buf = NULL;
+        return r < 0 ? -1 : 0;
+    }
+    *len = (size_t)r;
+    info->raw_len = (uint32_t)r;
+    info->raw_crc = gsea_crc32c(*buf, *len);
+    return 1;
+}
+
+int gsea_sink_check(const gsea_sink_t *sink, const uint8_t *data, size_t len,
+                    const gsea_blkinfo_t *info){
+    if (!sink->check_raw) return 0;
+    if (len != info->raw_len){
+        fprintf(stderr, "error: bloque decodificado de %zu bytes, se esperaban %u\n",
+                len, info->raw_len);
+        return -1;
+    }
+    if (sink->check_crc && gsea_crc32c(data, len) != info->raw_crc){
+        fprintf(stderr, "error: el bloque decodificado no coincide con el original "
+                        "(CRC32C); ¿clave incorrecta?\n");
+        return -1;
+    }
+    return 0;
+}
+
+int gsea_sink_put(gsea_sink_t *sink, const uint8_t *data, size_t len,
+                  const gsea_blkinfo_t *info){
+    sink->total_raw += info->raw_len;
+    sink->nblocks++;
+    if (sink->fd < 0) return 0;
+    if (!sink->framed){
+        if (gsea_write_full(sink->fd, data, len) != 0){
+            perror("write");
+            return -1;
+        }
+        return 0;
+    }
+
+    if (len == 0 || len > UINT32_MAX){
+        fprintf(stderr, "error: bloque de %zu bytes no representable\n", len);
+        return -1;
+    }
+    if (gsea_frame_write(sink->fd, data, (uint32_t)len, info) != 0){
+        perror("write");
+        return -1;
+    }
+    if (gsea_index_add(&sink->idx, (uint32_t)len, info->raw_len) != 0){
+        fprintf(stderr, "error: sin memoria para la tabla de bloques\n");
+        return -1;
+    }
+    return 0;
+}
+
+int gsea_stream_open(const gsea_opts_t *opt, const gsea_header_t *in_hdr, gsea_stream_t *st){
+    memset(st, 0, sizeof(*st));
+    size_t chunk = opt->chunk_size ? opt->chunk_size : GSEA_DEFAULT_CHUNK;
+
+    int fd = gsea_open_in(opt->in_path);
+    if (fd < 0){
+        perror("open in");
+        return -1;
+    }
+
+    gsea_header_t hdr;
+    int framed_in = 1;
+    if (in_hdr){
+        // el llamador ya lo leyó: se saltea hasta el primer frame
+        hdr = *in_hdr;
+        if (lseek(fd, (off_t)gsea_header_size(&hdr), SEEK_SET) < 0){
+            perror("lseek");
+            gsea_close_fd(fd);
+            return -1;
+        }
+    } else {
+        framed_in = gsea_container_probe(fd, &hdr, st->src.pre, &st->src.pre_len);
+    }
+    if (framed_in < 0 ||
+        gsea_plan_build(opt, framed_in, &hdr, chunk, &st->plan) != 0){
+        gsea_close_fd(fd);
+        return -1;
+    }
+
+    // --verify: se decodifica todo y se comprueba, sin salida
+    int fd_out = -1;
+    if (opt->verify){
+        if (!st->plan.framed_in || st->plan.framed_out){
+            fprintf(stderr, "error: --verify requiere un contenedor y la cadena inversa completa\n");
+            gsea_close_fd(fd);
+            return -1;
+        }
+    } else {
+        fd_out = gsea_open_out(opt->out_path);
+        if (fd_out < 0){
+            perror("open out");
+            gsea_close_fd(fd);
+            return -1;
+        }
+    }
+
+    st->in_path = opt->in_path;
+    st->src.fd = fd;
+    st->src.framed = st->plan.framed_in;
+    st->src.hdr = st->plan.in_hdr;
+    st->src.chunk = chunk;
+    st->sink.fd = fd_out;
+    st->sink.framed = st->plan.framed_out;
+    st->sink.check_raw = st->plan.framed_in && !st->plan.framed_out;
+    st->sink.check_crc = st->sink.check_raw && (st->plan.in_hdr.flags & GSEA_HDR_RAW_CRC);
+    st->sink.idx.frame_hdr = GSEA_FRAME_HDR;
+
+    if (st->sink.framed){
+        if (gsea_header_write(fd_out, &st->plan.out_hdr) != 0){
+            perror("write header");
+            gsea_close_fd(fd);
+            gsea_close_fd(fd_out);
+            return -1;
+        }
+        st->sink.idx.pos = gsea_header_size(&st->plan.out_hdr);
+    }
+    return 0;
+}
+
+int gsea_stream_close(gsea_stream_t *st, int rc){
+    if (rc == 0 && st->sink.framed){
+        if (gsea_index_finish(st->sink.fd, &st->sink.idx) != 0){
+            perror("write");
+            rc = -1;
+        } else {
+            gsea_header_patch_size(st->sink.fd, st->sink.total_raw);
+        }
+    }
+    gsea_index_free(&st->sink.idx);
+    gsea_close_fd(st->src.fd);
+    if (gsea_close_fd(st->sink.fd) != 0 && rc == 0){
+        perror("close out");
+        rc = -1;
+    }
+    if (st->sink.fd < 0 && rc == 0){
+        printf("OK %s: %llu bloques, %llu bytes%s\n", st->in_path,
+               (unsigned long long)st->sink.nblocks,
+               (unsigned long long)st->sink.total_raw,
+               st->sink.check_crc ? "" : " (versión 1, sin CRC)");
+    }
+    return rc;
+}
+
+int gsea_process_stream(const gsea_opts_t *opt){
+    if (opt->parallel_blocks && opt->ops_count > 0){
+        return gsea_process_blocks(opt, NULL);
+    }
+    if (opt->pipelined && opt->ops_count > 0){
+        return gsea_process_stream_pipelined(opt);
+    }
+
+    gsea_stream_t st;
+    if (gsea_stream_open(opt, NULL, &st) != 0) return -1;
+    return gsea_stream_run(opt, &st);
+}
+
+int gsea_stream_run(const gsea_opts_t *opt, gsea_stream_t *st){
+    int rc = 0;
+    for (;;){
+        uint8_t *blk = NULL;
+        size_t blklen = 0;
+        gsea_blkinfo_t info = { 0, 0 };
+        int nr = gsea_source_next(&st->src, &blk, &blklen, &info);
+        if (nr <= 0){
+            rc = nr;
+            break;
+        }
+
+        uint8_t *res = NULL;
+        size_t reslen = 0;
+        int ar = gsea_plan_apply(&st->plan, opt, info.raw_len, 0, st->plan.nsteps,
+                                 blk, blklen, &res, &reslen);
+        free(blk);
+        if (ar != 0){
+            rc = -1;
+            break;
+        }
+
+        int wr = gsea_sink_check(&st->sink, res, reslen, &info) == 0
+            ? gsea_sink_put(&st->sink, res, reslen, &info) : -1;
+        free(res);
+        if (wr != 0){
+            rc = -1;
+            break;
+        }
+    }
+
+    return gsea_stream_close(st, rc);
+}
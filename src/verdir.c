@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,11 +7,22 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/sendfile.h>
 #include <dirent.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <time.h>
 #include "gsea.h"
 #include "pipeline.h"
+#include "uring.h"
+#include "walk.h"
+#include "manifest.h"
+#include "cpus.h"
+#include "pool.h"
+#include "stream.h"
+#include "log.h"
+#include "stats.h"
+#include "budget.h"
 
 int fs_is_dir(const char *path){
     struct stat st;
@@ -44,6 +56,116 @@ int fs_list_dir(const char *dirpath){
     return 0;
 }
 
+// errores con los que una vía de copia en kernel no aplica y hay que
+// probar la siguiente (fs distintos, syscall ausente, tipo de fd no soportado)
+static int copy_unsupported(int err){
+    return err == ENOSYS || err == EXDEV || err == EINVAL ||
+           err == EOPNOTSUPP || err == ENOTSUP;
+}
+
+// Cada vía copia desde la posición actual de ambos fds hasta EOF.
+// Devuelven 0 al terminar, 1 si la vía no está soportada (sin haber avanzado
+// por la última llamada) y -1 en error.
+static int copy_cfr(int in, int out){
+    for (;;){
+        ssize_t r = copy_file_range(in, NULL, out, NULL, 1 << 30, 0);
+        if (r == 0) return 0;
+        if (r < 0){
+            if (errno == EINTR) continue;
+            return copy_unsupported(errno) ? 1 : -1;
+        }
+    }
+}
+
+static int copy_sendfile(int in, int out){
+    for (;;){
+        ssize_t r = sendfile(out, in, NULL, 1 << 30);
+        if (r == 0) return 0;
+        if (r < 0){
+            if (errno == EINTR) continue;
+            return copy_unsupported(errno) ? 1 : -1;
+        }
+    }
+}
+
+static int copy_splice(int in, int out){
+    int p[2];
+    if (pipe(p) != 0) return 1;
+    int rc = 0;
+    for (;;){
+        ssize_t r = splice(in, NULL, p[1], NULL, 1 << 16, SPLICE_F_MOVE);
+        if (r == 0) break;
+        if (r < 0){
+            if (errno == EINTR) continue;
+            rc = copy_unsupported(errno) ? 1 : -1;
+            break;
+        }
+        // vaciar el pipe completo hacia la salida
+        while (r > 0){
+            ssize_t w = splice(p[0], NULL, out, NULL, (size_t)r, SPLICE_F_MOVE);
+            if (w < 0){
+                if (errno == EINTR) continue;
+                rc = -1;
+                break;
+            }
+            r -= w;
+        }
+        if (rc != 0) break;
+    }
+    close(p[0]);
+    close(p[1]);
+    return rc;
+}
+
+static int copy_rw(int in, int out){
+    char buf[1 << 16];
+    for (;;){
+        ssize_t r = read(in, buf, sizeof(buf));
+        if (r == 0) return 0;
+        if (r < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        ssize_t done = 0;
+        while (done < r){
+            ssize_t w = write(out, buf + done, (size_t)(r - done));
+            if (w < 0){
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            done += w;
+        }
+    }
+}
+
+int fs_copy_file(const char *infile, const char *outfile){
+    int in = open(infile, O_RDONLY);
+    if (in < 0){
+        perror("open in");
+        return -1;
+    }
+    int out = open(outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0){
+        perror("open out");
+        close(in);
+        return -1;
+    }
+
+    // copia en kernel: copy_file_range -> sendfile -> splice -> read/write
+    int rc = copy_cfr(in, out);
+    if (rc == 1) rc = copy_sendfile(in, out);
+    if (rc == 1) rc = copy_splice(in, out);
+    if (rc == 1) rc = copy_rw(in, out);
+    if (rc != 0) perror("copy");
+
+    close(in);
+    if (close(out) != 0 && rc == 0){
+        perror("close out");
+        rc = -1;
+    }
+    return rc;
+}
+
 int fs_ensure_dir(const char *dirpath){
     struct stat st;
     if (stat(dirpath, &st) == 0){
@@ -58,185 +180,523 @@ int fs_ensure_dir(const char *dirpath){
     return 0;
 }
 
-struct thread_arg {
-    gsea_opts_t base;      // copia de opciones
-    char in_file[4096];    // ruta completa de entrada
-    char out_file[4096];   // ruta completa de salida
-};
+// cola de trabajos de un worker, de mayor a menor tamaño
+typedef struct {
+    size_t *idx;              // índices en jobs
+    size_t head, tail;        // pendientes: idx[head..tail); tail no cambia
+    uint64_t bytes;           // bytes pendientes, para elegir a quién robar
+    pthread_mutex_t lock;
+} job_queue_t;
+
+// archivo grande repartido en bloques entre todos los workers
+typedef struct {
+    gsea_blkjob_t *bj;
+    size_t job;               // índice en jobs
+    int64_t start, wait;      // --stats
+} split_file_t;
 
 struct pool_ctx {
-    struct thread_arg *args;  
+    const gsea_opts_t *opt;
+    gsea_file_job_t *jobs;
     size_t count;             // para el número total de archivos
-    size_t next;              // índice del próximo archivo a asignar
-    pthread_mutex_t lock;     // protege 'next' para concurrencia
+    job_queue_t *queues;      // una por worker
+    size_t nqueues;
+    int failed;               // algún archivo falló
+    int64_t t0;               // --stats: arranque, para la espera de cada archivo
+    gsea_budget_t *budget;    // --mem-budget, o NULL
+
+    // Archivos de al menos 'split_min' bytes que van por bloques se reparten:
+    // sus bloques los toma cualquier worker antes que un archivo nuevo. La
+    // capacidad alcanza para todos los candidatos, así las entradas no se
+    // mueven y se leen sin lock una vez publicadas en 'nsplit'
+    split_file_t *split;
+    size_t nsplit;
+    uint64_t split_min;
+    size_t split_window;      // bloques en vuelo por archivo repartido
+
+    // Cantidad de workers adaptativa: arrancan 'min_active' (uno por CPU
+    // disponible) y se suman más solo si las CPUs no llegan a saturarse,
+    // es decir si los workers pasan tiempo bloqueados en E/S
+    int adaptive;
+    size_t active;            // workers con id < active toman trabajo
+    size_t min_active, max_active;
+    int cpus;
+    struct timespec last_wall, last_cpu;
+    int done;                 // no quedan trabajos pendientes
+    pthread_cond_t wake;      // despierta a los workers estacionados
+    pthread_mutex_t lock;     // protege 'failed', 'nsplit' y lo adaptativo
+};
+
+struct worker_arg {
+    struct pool_ctx *ctx;
+    size_t id;                // cola propia
 };
 
-static void *thread_worker(void *ptr){
-    struct pool_ctx *ctx = (struct pool_ctx*)ptr;
+// toma el trabajo más grande de la cola; 1 si había alguno
+static int queue_pop(struct pool_ctx *ctx, job_queue_t *q, size_t *idx){
+    pthread_mutex_lock(&q->lock);
+    size_t h = q->head;
+    int got = h < q->tail;
+    if (got){
+        *idx = q->idx[h];
+        // los ladrones leen head y bytes sin el lock
+        __atomic_store_n(&q->head, h + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&q->bytes, q->bytes - ctx->jobs[*idx].size, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return got;
+}
 
-    for(;;){
-        // Toma el siguiente índice disponible
-        pthread_mutex_lock(&ctx->lock);
-        if (ctx->next >= ctx->count){
-            pthread_mutex_unlock(&ctx->lock);
-            break;
+// Próximo trabajo: primero la cola propia; vacía, se roba a la cola con más
+// bytes pendientes. Se roba también el más grande (no el del otro extremo,
+// como en un deque clásico): con los tamaños conocidos es el que alargaría
+// la cola final. Nunca se agregan trabajos, así que sin nada que robar
+// el worker termina.
+static int next_job(struct pool_ctx *ctx, size_t self, size_t *idx){
+    if (queue_pop(ctx, &ctx->queues[self], idx)) return 1;
+    for (;;){
+        size_t victim = ctx->nqueues;
+        uint64_t most = 0;
+        int any = 0;
+        for (size_t i = 0; i < ctx->nqueues; i++){
+            job_queue_t *q = &ctx->queues[i];
+            // lectura sin lock: solo orienta la elección
+            uint64_t b = __atomic_load_n(&q->bytes, __ATOMIC_RELAXED);
+            size_t pend = q->tail - __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+            if (pend == 0) continue;
+            if (!any || b > most){
+                victim = i;
+                most = b;
+                any = 1;
+            }
         }
-        size_t idx = ctx->next++;
-        pthread_mutex_unlock(&ctx->lock);
+        if (!any) return 0;
+        if (queue_pop(ctx, &ctx->queues[victim], idx)) return 1;
+    }
+}
 
-        struct thread_arg *a = &ctx->args[idx];
+#define POOL_SAMPLE_NS  50000000LL   // cada cuánto se mide el uso de CPU
+#define POOL_BUSY_LOW   0.85         // por debajo: sumar workers
+#define POOL_BUSY_HIGH  0.97         // por encima con sobresuscripción: quitar
 
-        pthread_t tid = pthread_self();
-        fprintf(stderr,
-                "[hilo %lu] inicio %s -> %s (idx=%zu)\n",
-                (unsigned long)tid, a->in_file, a->out_file, idx);
+static int64_t ts_ns(const struct timespec *t){
+    return (int64_t)t->tv_sec * 1000000000LL + t->tv_nsec;
+}
 
-        // ajustar rutas en la copia de opciones
-        a->base.in_path  = a->in_file;
-        a->base.out_path = a->out_file;
+// Tras cada archivo: si pasó el intervalo, compara el tiempo de CPU del
+// proceso con el disponible (reloj x CPUs). Si las CPUs no se saturan los
+// workers activos están esperando E/S y conviene sumar; si se saturan y hay
+// más workers que CPUs, sobran. Con --jobs la cantidad es fija.
+static void pool_adapt(struct pool_ctx *ctx){
+    if (!ctx->adaptive) return;
+    struct timespec wall, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
 
-        int rc = gsea_process_file(&a->base);
-        if (rc != 0){
-            fprintf(stderr,
-                    "[hilo %lu] fallo %s -> %s rc=%d\n",
-                    (unsigned long)tid, a->in_file, a->out_file, rc);
-        } else {
-            fprintf(stderr,
-                    "[hilo %lu] OK %s -> %s\n",
-                    (unsigned long)tid, a->in_file, a->out_file);
+    pthread_mutex_lock(&ctx->lock);
+    int64_t dw = ts_ns(&wall) - ts_ns(&ctx->last_wall);
+    if (dw >= POOL_SAMPLE_NS){
+        int64_t dc = ts_ns(&cpu) - ts_ns(&ctx->last_cpu);
+        double busy = (double)dc / ((double)dw * ctx->cpus);
+        size_t want = ctx->active;
+        if (busy < POOL_BUSY_LOW){
+            // proporcional a lo que falta para saturar, al menos uno más
+            want = (size_t)((double)ctx->active * POOL_BUSY_LOW / (busy > 0.05 ? busy : 0.05));
+            if (want <= ctx->active) want = ctx->active + 1;
+        } else if (busy > POOL_BUSY_HIGH && ctx->active > ctx->min_active){
+            want = ctx->active - 1;
+        }
+        if (want > ctx->max_active) want = ctx->max_active;
+        if (want < ctx->min_active) want = ctx->min_active;
+        if (want != ctx->active){
+            GSEA_LOG(GSEA_LOG_DEBUG, "pool", "cpu %.0f%%: workers activos %zu -> %zu",
+                     busy * 100.0, ctx->active, want);
+            if (want > ctx->active) pthread_cond_broadcast(&ctx->wake);
+            ctx->active = want;
         }
+        ctx->last_wall = wall;
+        ctx->last_cpu = cpu;
     }
-    return NULL;
+    pthread_mutex_unlock(&ctx->lock);
 }
 
-int fs_process_dir_concurrent(const gsea_opts_t *opt){
-    if (fs_ensure_dir(opt->out_path) != 0){
-        return -1;
+// espera mientras este worker sobre; 0 si hay que terminar
+static int pool_wait_turn(struct pool_ctx *ctx, size_t id){
+    pthread_mutex_lock(&ctx->lock);
+    while (id >= ctx->active && !ctx->done){
+        pthread_cond_wait(&ctx->wake, &ctx->lock);
     }
+    int go = !ctx->done || id < ctx->active;
+    pthread_mutex_unlock(&ctx->lock);
+    return go;
+}
 
-    DIR *d = opendir(opt->in_path);
-    if (!d){ perror("opendir in"); return -1; }
+// mayor tamaño primero; a igual tamaño, orden de la ruta (reproducible)
+static int job_cmp_size_desc(const void *a, const void *b){
+    const gsea_file_job_t *x = a, *y = b;
+    if (x->size != y->size) return x->size < y->size ? 1 : -1;
+    return strcmp(x->in_path, y->in_path);
+}
 
-    /// Contar archivos regulares
-    size_t count = 0;
-    struct dirent *de;
-    while ((de = readdir(d))){
-        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
-        char full[4096];
-        int r = snprintf(full, sizeof(full), "%s/%s", opt->in_path, de->d_name);
-        if (r < 0 || r >= (int)sizeof(full)) continue;
-        struct stat st;
-        if (stat(full, &st) == -1) continue;
-        if (S_ISREG(st.st_mode)) count++;
-    }
+static const char *job_out(const gsea_file_job_t *j){
+    return j->out_path ? j->out_path : "-";
+}
 
-    if (count == 0){
-        fprintf(stderr, "No hay archivos regulares en el directorio.\n");
-        closedir(d);
-        return 0;
+static void pool_fail(struct pool_ctx *ctx){
+    pthread_mutex_lock(&ctx->lock);
+    ctx->failed = 1;
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// --stats: el tamaño de la salida se toma del archivo escrito
+static void stats_file(const gsea_file_job_t *j, int64_t start, int64_t wait, int ok){
+    struct stat st;
+    uint64_t out = j->out_path && stat(j->out_path, &st) == 0 ? (uint64_t)st.st_size : 0;
+    gsea_stats_file(j->in_path, j->size, out, start, gsea_stats_now(), wait, ok);
+}
+
+// el último bloque de un archivo repartido ya se escribió (o falló alguno)
+static void split_end(struct pool_ctx *ctx, const split_file_t *sf){
+    gsea_file_job_t *j = &ctx->jobs[sf->job];
+    int rc = gsea_blkjob_finish(sf->bj);
+    if (rc != 0) pool_fail(ctx);
+    else j->ok = 1;
+    if (gsea_stats_on) stats_file(j, sf->start, sf->wait, rc == 0);
+    GSEA_LOG(rc != 0 ? GSEA_LOG_ERROR : GSEA_LOG_DEBUG, "archivo", "%s %s -> %s (%zu bloques)",
+             rc != 0 ? "fallo" : "OK", j->in_path, job_out(j), gsea_blkjob_blocks(sf->bj));
+}
+
+static void split_open(struct pool_ctx *ctx, size_t idx, const gsea_opts_t *opt,
+                       const gsea_header_t *hdr){
+    const gsea_file_job_t *j = &ctx->jobs[idx];
+    int64_t start = gsea_stats_on ? gsea_stats_now() : 0;
+    gsea_blkjob_t *bj = gsea_blkjob_open(opt, hdr, ctx->split_window);
+    if (!bj){
+        pool_fail(ctx);
+        if (gsea_stats_on) stats_file(j, start, start - ctx->t0, 0);
+        GSEA_LOG(GSEA_LOG_ERROR, "archivo", "fallo %s -> %s", j->in_path, job_out(j));
+        return;
     }
+    pthread_mutex_lock(&ctx->lock);
+    split_file_t *sf = &ctx->split[ctx->nsplit];
+    sf->bj = bj;
+    sf->job = idx;
+    sf->start = start;
+    sf->wait = start - ctx->t0;
+    ctx->nsplit++;
+    pthread_mutex_unlock(&ctx->lock);
 
-    rewinddir(d);
+    GSEA_LOG(GSEA_LOG_DEBUG, "archivo", "%s -> %s repartido en %zu bloques (idx=%zu)",
+             j->in_path, job_out(j), gsea_blkjob_blocks(bj), idx);
+    if (gsea_blkjob_blocks(bj) == 0) split_end(ctx, sf);
+}
 
-    // Preparar array de los trabajos
-    struct thread_arg *args = calloc(count, sizeof(*args));
-    if (!args){
-        perror("calloc args");
-        closedir(d);
-        return -1;
+// procesa un bloque de algún archivo repartido; 1 si hubo alguno. Con 'wait'
+// espera lugar en la ventana en vez de buscar otro trabajo. Con --stats suma
+// a 'busy' el tiempo del bloque
+static int split_step(struct pool_ctx *ctx, int wait, int64_t *busy){
+    pthread_mutex_lock(&ctx->lock);
+    size_t n = ctx->nsplit;
+    pthread_mutex_unlock(&ctx->lock);
+    for (size_t s = 0; s < n; s++){
+        split_file_t *sf = &ctx->split[s];
+        size_t blk;
+        if (gsea_blkjob_take(sf->bj, wait, &blk) != 1) continue;
+        int64_t t0 = gsea_stats_on ? gsea_stats_now() : 0;
+        if (gsea_blkjob_run(sf->bj, blk)) split_end(ctx, sf);
+        if (gsea_stats_on) *busy += gsea_stats_now() - t0;
+        return 1;
     }
+    return 0;
+}
 
-    size_t idx = 0;
-    while ((de = readdir(d))){
-        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) continue;
-        char full[4096];
-        int r = snprintf(full, sizeof(full), "%s/%s", opt->in_path, de->d_name);
-        if (r < 0 || r >= (int)sizeof(full)) continue;
-        struct stat st;
-        if (stat(full, &st) == -1) continue;
-        if (!S_ISREG(st.st_mode)) continue;
+static int thread_worker(void *ptr){
+    struct worker_arg *arg = ptr;
+    struct pool_ctx *ctx = arg->ctx;
 
-        struct thread_arg *a = &args[idx];
-        a->base = *opt;
-        snprintf(a->in_file,  sizeof(a->in_file),  "%s", full);
-        snprintf(a->out_file, sizeof(a->out_file), "%s/%s",
-                 opt->out_path, de->d_name);
+    // buffers reutilizados entre los archivos que procesa este hilo
+    gsea_worker_t w;
+    memset(&w, 0, sizeof(w));
+    // copia de opciones; solo cambian las rutas de cada archivo
+    gsea_opts_t base = *ctx->opt;
+    int64_t alive = gsea_stats_on ? gsea_stats_now() : 0;
+    int64_t busy = 0;
+
+    size_t idx;
+    while (pool_wait_turn(ctx, arg->id)){
+        // primero los bloques pendientes de un archivo repartido: así el
+        // archivo grande avanza con todos los cores y los chicos rellenan
+        if (split_step(ctx, 0, &busy)){
+            pool_adapt(ctx);
+            continue;
+        }
+        if (!next_job(ctx, arg->id, &idx)){
+            // sin archivos por tomar: esperar lugar en la ventana de alguno
+            // repartido; si no queda ningún bloque, terminó
+            if (split_step(ctx, 1, &busy)) continue;
+            break;
+        }
+        gsea_file_job_t *j = &ctx->jobs[idx];
 
-        fprintf(stderr,
-                "[prep] idx=%zu archivo=%s -> %s\n",
-                idx, a->in_file, a->out_file);
+        // ajustar rutas en la copia de opciones (y deshacer el modo stream
+        // que --mem-budget pudo fijar para el archivo anterior)
+        base.in_path  = j->in_path;
+        base.out_path = j->out_path;
+        base.stream   = ctx->opt->stream;
 
-        idx++;
+        int64_t start = gsea_stats_on ? gsea_stats_now() : 0;
+        // el header de la entrada se lee una vez para decidir el camino y
+        // lo reusa quien decodifica
+        gsea_input_t in = { 0 };
+        int blocks = gsea_file_uses_blocks(&base, &in);
+        if (j->size >= ctx->split_min && blocks){
+            split_open(ctx, idx, &base, in.framed == 1 ? &in.hdr : NULL);
+            if (gsea_stats_on) busy += gsea_stats_now() - start;
+            continue;
+        }
+
+        GSEA_LOG(GSEA_LOG_TRACE, "archivo", "inicio %s -> %s (idx=%zu)",
+                 j->in_path, job_out(j), idx);
+
+        // --mem-budget: esperar a que el pico estimado del archivo entre junto
+        // a los que están en curso (el camino por bloques se acota solo)
+        if (ctx->budget){
+            int whole = base.ops_count > 0 && !base.has_range && !blocks;
+            uint64_t need = whole ? gsea_budget_fit(ctx->budget, &base, j->size) : 0;
+            gsea_budget_begin(ctx->budget, &w, need);
+        }
+        int rc = gsea_process_file_ws(&base, &w, &in);
+        if (ctx->budget) gsea_budget_end(ctx->budget, &w);
+        if (rc != 0){
+            pool_fail(ctx);
+            GSEA_LOG(GSEA_LOG_ERROR, "archivo", "fallo %s -> %s rc=%d",
+                     j->in_path, job_out(j), rc);
+        } else {
+            j->ok = 1;
+            GSEA_LOG(GSEA_LOG_DEBUG, "archivo", "OK %s -> %s", j->in_path, job_out(j));
+        }
+        if (gsea_stats_on){
+            stats_file(j, start, start - ctx->t0, rc == 0);
+            busy += gsea_stats_now() - start;
+        }
+        pool_adapt(ctx);
     }
-    closedir(d);
 
-    // ajustar el conteo de archivos si algunos se saltaron por errores
-    count = idx;
+    // no queda nada para tomar ni robar: liberar a los estacionados
+    pthread_mutex_lock(&ctx->lock);
+    ctx->done = 1;
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->lock);
+
+    gsea_worker_free(&w);
+    if (gsea_stats_on) gsea_stats_worker(gsea_stats_now() - alive, busy);
+    return 0;
+}
+
+// procesa los archivos del recorrido; cada uno que termina bien queda 'ok'
+static int process_walk(const gsea_opts_t *opt, gsea_walk_t *walk, double walk_ms){
+    int walk_rc = walk->failed ? -1 : 0;
+    size_t count = walk->count;
     if (count == 0){
-        free(args);
-        fprintf(stderr, "No se pudo preparar ningún archivo.\n");
-        return 0;
+        GSEA_LOG(GSEA_LOG_INFO, NULL, "%s", opt->manifest ? "No hay archivos que procesar."
+                                            : "No hay archivos regulares en el directorio.");
+        return walk_rc;
+    }
+    // los más grandes primero: un archivo enorme que sale último en readdir
+    // dejaría a los demás cores esperando
+    qsort(walk->jobs, count, sizeof(*walk->jobs), job_cmp_size_desc);
+    for (size_t idx = 0; idx < count; idx++){
+        GSEA_LOG(GSEA_LOG_TRACE, "prep", "idx=%zu archivo=%s -> %s",
+                 idx, walk->jobs[idx].in_path, job_out(&walk->jobs[idx]));
     }
+    GSEA_LOG(GSEA_LOG_INFO, "walk", "directorios=%zu archivos=%zu en %.1f ms",
+             walk->dirs, count, walk_ms);
 
-    // Calcular número de hilos 
-    long cores = sysconf(_SC_NPROCESSORS_ONLN);
-    if (cores < 1) cores = 1;
+    // Con io_uring un hilo hace toda la E/S en lotes y el cómputo usa un
+    // worker por core; solo aplica al camino de archivo completo en memoria
+    if (!opt->no_uring && opt->ops_count > 0 && !opt->stream &&
+        !opt->use_mmap && !opt->has_range && !opt->verify){
+        int rc = gsea_dir_uring(opt, walk->jobs, count);
+        if (rc != -2){
+            return rc != 0 ? rc : walk_rc;
+        }
+        GSEA_LOG(GSEA_LOG_INFO, "pool", "io_uring no disponible (%s), E/S bloqueante",
+                 strerror(errno));
+    }
+
+    // Calcular número de hilos: con --jobs exactamente esos; si no, uno por
+    // CPU disponible (cuota del cgroup y afinidad incluidas) y hasta 4 por
+    // CPU si la E/S bloquea
+    int cpus = gsea_cpu_count();
+    int adaptive = opt->jobs <= 0;
+    size_t min_workers = (size_t)gsea_jobs(opt);
+    size_t max_workers = adaptive ? (size_t)cpus * 4 : min_workers;
+
+    // Un archivo con al menos la parte pareja de un worker (y más de un bloque)
+    // se reparte en bloques si su camino es por bloques; hay como mucho
+    // 'min_workers' así. Los demás se procesan enteros
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) total += walk->jobs[i].size;
+    char first = opt->ops_count > 0 ? opt->ops_order[0] : 0;
+    int decoding = opt->verify || first == 'd' || first == 'u';
+    int may_split = !opt->has_range && (decoding || (opt->ops_count > 0 && opt->stream));
+    uint64_t split_min = total / min_workers;
+    // al codificar los bloques salen de --chunk-size; al decodificar, de la
+    // tabla del contenedor
+    uint64_t chunk = opt->chunk_size ? opt->chunk_size : GSEA_DEFAULT_CHUNK;
+    if (!decoding && split_min <= chunk) split_min = chunk + 1;
+    size_t nsplit_max = 0;
+    while (may_split && nsplit_max < count && walk->jobs[nsplit_max].size >= split_min){
+        nsplit_max++;           // la lista está ordenada de mayor a menor
+    }
 
-    size_t max_workers = (size_t)cores * 4;
-    if (max_workers > count) max_workers = count;
+    // con archivos repartidos hay trabajo para más hilos que archivos
+    if (max_workers > count && nsplit_max == 0) max_workers = count;
+    if (min_workers > max_workers) min_workers = max_workers;
 
-    fprintf(stderr,
-            "[pool] archivos=%zu, cores=%ld, workers=%zu\n",
-            count, cores, max_workers);
+    GSEA_LOG(GSEA_LOG_INFO, "pool", "archivos=%zu, cpus=%d, workers=%zu%s, repartibles=%zu",
+             count, cpus, min_workers,
+             adaptive && max_workers > min_workers ? " (adaptativo)" : "",
+             nsplit_max);
 
-    pthread_t *tids = calloc(max_workers, sizeof(*tids));
-    if (!tids){
-        perror("calloc tids");
-        free(args);
+    // --mem-budget: cada worker retiene buffers entre archivos
+    gsea_budget_t budget;
+    if (opt->mem_budget && gsea_budget_init(&budget, opt, max_workers) != 0) return -1;
+
+    gsea_pool_t *pool = gsea_pool_shared();
+    struct worker_arg *wargs = calloc(max_workers, sizeof(*wargs));
+    job_queue_t *queues = calloc(max_workers, sizeof(*queues));
+    size_t *qidx = malloc(count * sizeof(*qidx));
+    split_file_t *split = calloc(nsplit_max ? nsplit_max : 1, sizeof(*split));
+    if (!pool || !wargs || !queues || !qidx || !split){
+        perror("calloc pool");
+        free(wargs);
+        free(queues);
+        free(qidx);
+        free(split);
+        if (opt->mem_budget) gsea_budget_destroy(&budget);
         return -1;
     }
 
     struct pool_ctx ctx;
-    ctx.args = args;
+    ctx.opt = opt;
+    ctx.jobs = walk->jobs;
     ctx.count = count;
-    ctx.next  = 0;
+    ctx.queues = queues;
+    ctx.nqueues = max_workers;
+    ctx.failed = 0;
+    ctx.t0 = gsea_stats_on ? gsea_stats_now() : 0;
+    ctx.budget = opt->mem_budget ? &budget : NULL;
+    ctx.split = split;
+    ctx.nsplit = 0;
+    ctx.split_min = nsplit_max ? split_min : UINT64_MAX;
+    ctx.split_window = max_workers * 2;
+    if (ctx.budget && nsplit_max > 0){
+        // los bloques en vuelo de los archivos repartidos usan a lo sumo la
+        // mitad de lo que queda para los archivos admitidos
+        uint64_t per = gsea_budget_estimate(&budget, chunk) * nsplit_max;
+        uint64_t fit = budget.limit / 2 / per;
+        if (fit < ctx.split_window) ctx.split_window = fit > 0 ? (size_t)fit : 1;
+    }
+    ctx.adaptive = adaptive && max_workers > min_workers;
+    ctx.active = min_workers;
+    ctx.min_active = min_workers;
+    ctx.max_active = max_workers;
+    ctx.cpus = cpus;
+    ctx.done = 0;
+    clock_gettime(CLOCK_MONOTONIC, &ctx.last_wall);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ctx.last_cpu);
     pthread_mutex_init(&ctx.lock, NULL);
+    pthread_cond_init(&ctx.wake, NULL);
 
-    // Crear los hilos worker
+    // Repartir en ronda la lista ordenada: cada cola queda de mayor a menor
+    // y con una mezcla parecida de tamaños. La cola i ocupa qidx[off..]
+    size_t off = 0;
+    for (size_t q = 0; q < max_workers; q++){
+        job_queue_t *jq = &queues[q];
+        jq->idx = qidx + off;
+        for (size_t j = q; j < count; j += max_workers){
+            jq->idx[jq->tail++] = j;
+            jq->bytes += walk->jobs[j].size;
+        }
+        off += jq->tail;
+        pthread_mutex_init(&jq->lock, NULL);
+    }
+
+    // Lanzar los workers en el pool compartido. Un worker estacionado o
+    // esperando lugar en la ventana de un archivo repartido se bloquea, así
+    // que cada uno va con su propio hilo (el pool crea los que falten)
+    gsea_group_t group;
+    gsea_group_init(&group);
     for (size_t i = 0; i < max_workers; i++){
-        int err = pthread_create(&tids[i], NULL, thread_worker, &ctx);
-        if (err != 0){
-            fprintf(stderr,
-                    "[pool] pthread_create fallo i=%zu: %s\n",
-                    i, strerror(err));
+        wargs[i].ctx = &ctx;
+        wargs[i].id = i;
+        if (gsea_pool_spawn(pool, &group, thread_worker, &wargs[i]) != 0){
             max_workers = i;
             break;
-        } else {
-            fprintf(stderr,
-                    "[pool] worker i=%zu tid=%lu creado\n",
-                    i, (unsigned long)tids[i]);
         }
     }
+    GSEA_LOG(GSEA_LOG_DEBUG, "pool", "%zu workers en marcha, %zu hilos en el pool",
+             max_workers, gsea_pool_threads(pool));
 
     //Esperar a que terminen
-    int global_rc = 0;
-    for (size_t i = 0; i < max_workers; i++){
-        void *ret = NULL;
-        int err = pthread_join(tids[i], &ret);
-        if (err != 0){
-            fprintf(stderr,
-                    "[join] worker i=%zu fallo join: %s\n",
-                    i, strerror(err));
-            global_rc = -1;
-        } else {
-            fprintf(stderr,
-                    "[join] worker i=%zu tid=%lu terminado\n",
-                    i, (unsigned long)tids[i]);
-        }
-    }
+    int global_rc = gsea_pool_wait(pool, &group);
+    gsea_group_destroy(&group);
+
+    // las colas de los hilos que no se crearon las vacían los demás robando
+    if (max_workers == 0) global_rc = -1;
+    if (ctx.failed) global_rc = -1;
+    if (walk_rc != 0) global_rc = -1;
 
+    if (ctx.budget){
+        gsea_budget_report(&budget);
+        gsea_budget_destroy(&budget);
+    }
+    for (size_t s = 0; s < ctx.nsplit; s++) gsea_blkjob_free(split[s].bj);
+    for (size_t q = 0; q < ctx.nqueues; q++) pthread_mutex_destroy(&queues[q].lock);
+    pthread_cond_destroy(&ctx.wake);
     pthread_mutex_destroy(&ctx.lock);
-    free(tids);
-    free(args);
+    free(wargs);
+    free(queues);
+    free(qidx);
+    free(split);
     return global_rc;
-}
\ No newline at end of file
+}
+
+int fs_process_dir_concurrent(const gsea_opts_t *opt){
+    // --verify no escribe: el directorio de salida no hace falta
+    if (!opt->verify && fs_ensure_dir(opt->out_path) != 0){
+        return -1;
+    }
+
+    // Listar los archivos regulares (con -r, todo el árbol; los
+    // subdirectorios de salida se crean durante el recorrido)
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    gsea_walk_t walk;
+    if (gsea_walk(opt->in_path, opt->verify ? NULL : opt->out_path,
+                  opt->recursive, &walk) != 0){
+        GSEA_LOG(GSEA_LOG_ERROR, NULL, "no se pudo recorrer '%s'", opt->in_path);
+        return -1;
+    }
+    if (walk.skipped_dirs > 0){
+        GSEA_LOG(GSEA_LOG_WARN, "walk", "%zu subdirectorios omitidos (use -r para recorrerlos)",
+                 walk.skipped_dirs);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double walk_ms = (double)(ts_ns(&t1) - ts_ns(&t0)) / 1e6;
+
+    // --manifest: solo los archivos que cambiaron desde la corrida anterior
+    gsea_manifest_t next;
+    if (opt->manifest && gsea_manifest_filter(opt, &walk, &next) != 0){
+        gsea_walk_free(&walk);
+        return -1;
+    }
+    int rc = process_walk(opt, &walk, walk_ms);
+    if (opt->manifest){
+        if (gsea_manifest_commit(opt, &walk, &next) != 0) rc = -1;
+        gsea_manifest_free(&next);
+    }
+    gsea_walk_free(&walk);
+    return rc;
+}
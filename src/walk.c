@@ -0,0 +1,307 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "walk.h"
+#include "cpus.h"
+#include "pool.h"
+#include "log.h"
+
+// hilos que expanden directorios en modo recursivo
+#define WALK_MIN_THREADS 2
+#define WALK_MAX_THREADS 32
+// buffer de getdents64 por hilo: cientos de entradas por syscall
+#define WALK_DENTS_BUF   (64u << 10)
+
+// registro que devuelve getdents64 (no está en todas las versiones de glibc)
+struct dirent64_raw {
+    uint64_t       d_ino;
+    int64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+};
+
+// directorio pendiente de expandir
+typedef struct {
+    const char *in;
+    const char *out;              // NULL si no hay salida
+} dir_item_t;
+
+struct walk_ctx {
+    int recursive;
+    // pila compartida: LIFO para que un árbol ancho no acumule miles de
+    // directorios pendientes antes de bajar
+    dir_item_t *stack;
+    size_t n, cap;
+    size_t active;                // directorios en la pila o siendo expandidos
+    pthread_mutex_t lock;
+    pthread_cond_t  more;
+};
+
+// Lo que encuentra un hilo; se junta al final, sin lock por archivo. Las
+// rutas (de archivos y de directorios pendientes) van a la arena del hilo
+typedef struct {
+    struct walk_ctx *c;
+    gsea_file_job_t *jobs;
+    size_t n, cap;
+    gsea_strarena_t strings;
+    char *dents;                  // buffer de getdents64
+    size_t dirs, skipped;
+    int failed;
+} walker_t;
+
+// "dir/name" en la arena; ld = strlen(dir)
+static char *path_join(gsea_strarena_t *a, const char *dir, size_t ld, const char *name){
+    size_t ln = strlen(name);
+    int slash = ld > 0 && dir[ld - 1] != '/';
+    char *s = gsea_strarena_alloc(a, ld + slash + ln + 1);
+    if (!s) return NULL;
+    memcpy(s, dir, ld);
+    if (slash) s[ld] = '/';
+    memcpy(s + ld + slash, name, ln + 1);
+    return s;
+}
+
+static int push_dir(struct walk_ctx *c, const char *in, const char *out){
+    pthread_mutex_lock(&c->lock);
+    if (c->n == c->cap){
+        size_t ncap = c->cap ? c->cap * 2 : 64;
+        dir_item_t *ns = realloc(c->stack, ncap * sizeof(*ns));
+        if (!ns){
+            pthread_mutex_unlock(&c->lock);
+            return -1;
+        }
+        c->stack = ns;
+        c->cap = ncap;
+    }
+    c->stack[c->n].in = in;
+    c->stack[c->n].out = out;
+    c->n++;
+    c->active++;
+    pthread_cond_signal(&c->more);
+    pthread_mutex_unlock(&c->lock);
+    return 0;
+}
+
+static int add_job(walker_t *w, const char *in, const char *out, const struct stat *st){
+    if (w->n == w->cap){
+        size_t ncap = w->cap ? w->cap * 2 : 256;
+        gsea_file_job_t *nj = realloc(w->jobs, ncap * sizeof(*nj));
+        if (!nj) return -1;
+        w->jobs = nj;
+        w->cap = ncap;
+    }
+    w->jobs[w->n].in_path = in;
+    w->jobs[w->n].out_path = out;
+    w->jobs[w->n].size = (uint64_t)st->st_size;
+    w->jobs[w->n].mtime_ns = (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+    w->jobs[w->n].ino = (uint64_t)st->st_ino;
+    w->jobs[w->n].ok = 0;
+    w->n++;
+    return 0;
+}
+
+// Lista un directorio: archivos a la lista del hilo, subdirectorios a la
+// pila. getdents64 directo trae cientos de entradas por syscall con su d_type;
+// fstatat solo hace falta para el tamaño de los archivos (el orden de mayor a
+// menor y las lecturas del lote lo usan), para seguir enlaces o si el fs no
+// informa el tipo.
+static void expand(walker_t *w, const dir_item_t *it){
+    int dfd = open(it->in, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0){
+        GSEA_LOG(GSEA_LOG_ERROR, "walk", "no se pudo abrir %s: %s", it->in, strerror(errno));
+        w->failed = 1;
+        return;
+    }
+    w->dirs++;
+    size_t lin = strlen(it->in);
+    size_t lout = it->out ? strlen(it->out) : 0;
+
+    for (;;){
+        long nr = syscall(SYS_getdents64, dfd, w->dents, WALK_DENTS_BUF);
+        if (nr < 0 && errno == EINTR) continue;
+        if (nr < 0){
+            GSEA_LOG(GSEA_LOG_ERROR, "walk", "error leyendo %s: %s", it->in, strerror(errno));
+            w->failed = 1;
+            break;
+        }
+        if (nr == 0) break;
+
+        for (long pos = 0; pos < nr;){
+            const struct dirent64_raw *de = (const void*)(w->dents + pos);
+            pos += de->d_reclen;
+            const char *name = de->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))){
+                continue;
+            }
+
+            unsigned char type = de->d_type;
+            struct stat st;
+            int have_st = 0;
+            if (type == DT_UNKNOWN || type == DT_LNK){
+                if (fstatat(dfd, name, &st, 0) != 0) continue;   // enlace roto
+                have_st = 1;
+                if (S_ISDIR(st.st_mode)){
+                    if (type == DT_LNK) continue;
+                    type = DT_DIR;
+                } else if (S_ISREG(st.st_mode)){
+                    type = DT_REG;
+                } else {
+                    continue;
+                }
+            }
+
+            if (type == DT_DIR){
+                if (!w->c->recursive){
+                    w->skipped++;
+                    continue;
+                }
+                char *in = path_join(&w->strings, it->in, lin, name);
+                char *out = it->out ? path_join(&w->strings, it->out, lout, name) : NULL;
+                if (!in || (it->out && !out)){
+                    w->failed = 1;
+                    continue;
+                }
+                if (out && mkdir(out, 0755) != 0 && errno != EEXIST){
+                    GSEA_LOG(GSEA_LOG_ERROR, "walk", "no se pudo crear %s: %s", out, strerror(errno));
+                    w->failed = 1;
+                    continue;
+                }
+                if (push_dir(w->c, in, out) != 0){
+                    GSEA_LOG(GSEA_LOG_ERROR, "walk", "sin memoria para %s", in);
+                    w->failed = 1;
+                }
+            } else if (type == DT_REG){
+                if (!have_st && fstatat(dfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                char *in = path_join(&w->strings, it->in, lin, name);
+                char *out = it->out ? path_join(&w->strings, it->out, lout, name) : NULL;
+                if (!in || (it->out && !out) || add_job(w, in, out, &st) != 0){
+                    w->failed = 1;
+                }
+            }
+        }
+    }
+    close(dfd);
+}
+
+static int walk_thread(void *ptr){
+    walker_t *w = ptr;
+    struct walk_ctx *c = w->c;
+
+    for (;;){
+        pthread_mutex_lock(&c->lock);
+        while (c->n == 0 && c->active > 0){
+            pthread_cond_wait(&c->more, &c->lock);
+        }
+        if (c->n == 0){
+            // nada pendiente ni en expansión: terminó el recorrido
+            pthread_mutex_unlock(&c->lock);
+            break;
+        }
+        dir_item_t it = c->stack[--c->n];
+        pthread_mutex_unlock(&c->lock);
+
+        expand(w, &it);
+
+        pthread_mutex_lock(&c->lock);
+        if (--c->active == 0) pthread_cond_broadcast(&c->more);
+        pthread_mutex_unlock(&c->lock);
+    }
+    return 0;
+}
+
+int gsea_walk(const char *in_root, const char *out_root, int recursive, gsea_walk_t *w){
+    memset(w, 0, sizeof(*w));
+
+    struct walk_ctx c;
+    memset(&c, 0, sizeof(c));
+    c.recursive = recursive;
+    pthread_mutex_init(&c.lock, NULL);
+    pthread_cond_init(&c.more, NULL);
+
+    size_t nthreads = 1;
+    if (recursive){
+        // listar espera al disco más que a la CPU: el doble de hilos que CPUs
+        nthreads = (size_t)gsea_cpu_count() * 2;
+        if (nthreads < WALK_MIN_THREADS) nthreads = WALK_MIN_THREADS;
+        if (nthreads > WALK_MAX_THREADS) nthreads = WALK_MAX_THREADS;
+    }
+    walker_t *ws = calloc(nthreads, sizeof(*ws));
+    gsea_pool_t *pool = nthreads > 1 ? gsea_pool_shared() : NULL;
+    // las raíces son del llamador y viven más que el recorrido
+    if (!ws || push_dir(&c, in_root, out_root) != 0){
+        perror("walk");
+        free(ws);
+        free(c.stack);
+        pthread_mutex_destroy(&c.lock);
+        pthread_cond_destroy(&c.more);
+        return -1;
+    }
+
+    // los que listan esperan más al disco que a la CPU y se esperan entre
+    // sí cuando la pila se vacía: cada uno con su hilo del pool
+    gsea_group_t g;
+    gsea_group_init(&g);
+    size_t started = 0;
+    for (size_t i = 0; i < nthreads; i++){
+        ws[i].c = &c;
+        ws[i].dents = malloc(WALK_DENTS_BUF);
+        if (!ws[i].dents) break;
+        if (i > 0 && (!pool || gsea_pool_spawn(pool, &g, walk_thread, &ws[i]) != 0)) break;
+        started++;
+    }
+    if (started == 0){
+        // sin buffer ni para el hilo llamador
+        perror("walk");
+        gsea_group_destroy(&g);
+        free(ws);
+        free(c.stack);
+        pthread_mutex_destroy(&c.lock);
+        pthread_cond_destroy(&c.more);
+        return -1;
+    }
+    // el llamador también recorre
+    walk_thread(&ws[0]);
+    if (pool) gsea_pool_wait(pool, &g);
+    gsea_group_destroy(&g);
+
+    // juntar lo de cada hilo
+    size_t total = 0;
+    for (size_t i = 0; i < nthreads; i++) total += ws[i].n;
+    w->jobs = malloc((total ? total : 1) * sizeof(*w->jobs));
+    int rc = w->jobs ? 0 : -1;
+    for (size_t i = 0; i < nthreads; i++){
+        if (w->jobs && ws[i].n){
+            memcpy(w->jobs + w->count, ws[i].jobs, ws[i].n * sizeof(*w->jobs));
+            w->count += ws[i].n;
+        }
+        gsea_strarena_merge(&w->strings, &ws[i].strings);
+        w->dirs += ws[i].dirs;
+        w->skipped_dirs += ws[i].skipped;
+        w->failed |= ws[i].failed;
+        free(ws[i].jobs);
+        free(ws[i].dents);
+    }
+    if (w->dirs == 0) rc = -1;    // ni la raíz se pudo abrir
+
+    free(c.stack);
+    free(ws);
+    pthread_mutex_destroy(&c.lock);
+    pthread_cond_destroy(&c.more);
+    if (rc != 0) gsea_walk_free(w);
+    return rc;
+}
+
+void gsea_walk_free(gsea_walk_t *w){
+    free(w->jobs);
+    gsea_strarena_free(&w->strings);
+    memset(w, 0, sizeof(*w));
+}
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Regresión: -d sin --dedup sobre una salida de --dedup debe reconstruir el
+# directorio (se detecta el almacén) y una receta suelta debe rechazarse.
+set -u
+BIN=${1:-./gsea}
+SRC=${2:-directorio_pruebas}
+T=$(mktemp -d)
+trap 'rm -rf "$T"' EXIT
+fail(){ echo "FALLO: $*"; exit 1; }
+
+"$BIN" -q -c --dedup -i "$SRC" -o "$T/dd" || fail "no se pudo deduplicar $SRC"
+
+# el directorio entero: se reconstruye igual que con --dedup
+"$BIN" -q -d -i "$T/dd" -o "$T/out" || fail "-d sobre la salida de --dedup"
+diff -r "$SRC" "$T/out" >/dev/null || fail "-d reconstruyó otro contenido"
+[ ! -e "$T/out/.gsea-chunks" ] || fail "-d decodificó el almacén como un archivo"
+
+# recetas sin su almacén (archivo solo y directorio, con y sin io_uring)
+mkdir "$T/recetas"
+cp "$T/dd"/arch1.txt "$T/dd"/arch2.txt "$T/recetas/"
+for args in "-i $T/recetas/arch1.txt -o $T/uno" \
+            "-i $T/recetas -o $T/dir" \
+            "--no-uring -i $T/recetas -o $T/dir2"; do
+    # shellcheck disable=SC2086
+    if "$BIN" -q -d $args 2>"$T/err"; then fail "-d $args terminó bien"; fi
+    grep -q -- "--dedup" "$T/err" || fail "-d $args no menciona --dedup"
+done
+echo "OK dedup_decode"